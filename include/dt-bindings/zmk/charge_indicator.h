@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+/* Parameters of the zmk,behavior-charge-indicator behavior (&chg_ind). */
+#define CHG_IND_TOG         0   /* toggle the indicator */
+#define CHG_IND_OFF         1   /* turn the indicator off (LEDs go back to the widget) */
+#define CHG_IND_ON          2   /* turn the indicator on */
+#define CHG_IND_NEXT_POLICY 3   /* cycle color -> battery level -> off */
+#define CHG_IND_SHOW_BAT    4   /* show the battery level now, charging or not */
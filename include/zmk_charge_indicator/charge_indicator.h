@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public interface of the charge indicator module for widgets and other modules. */
+
+/* Combined charging state (same order as the internal state: higher is more significant). */
+enum zmk_charge_indicator_state {
+    ZMK_CHARGE_INDICATOR_IDLE = 0,      /* not charging */
+    ZMK_CHARGE_INDICATOR_COMPLETE,      /* charge complete (tri-state STAT only) */
+    ZMK_CHARGE_INDICATOR_CHARGING,
+    ZMK_CHARGE_INDICATOR_FAULT,         /* charger fault (tri-state STAT only) */
+};
+
+/* Battery level band, from the configured thresholds (level-high/low/critical). */
+enum zmk_charge_indicator_band {
+    ZMK_CHARGE_INDICATOR_BAND_HIGH = 0,
+    ZMK_CHARGE_INDICATOR_BAND_MEDIUM,
+    ZMK_CHARGE_INDICATOR_BAND_LOW,
+    ZMK_CHARGE_INDICATOR_BAND_CRITICAL,
+    ZMK_CHARGE_INDICATOR_BAND_MISSING,  /* no battery reading yet */
+};
+
+/* Status snapshot, published by the indicator's LED thread on every update. */
+struct zmk_charge_indicator_status {
+    uint32_t transition_ms;     /* uptime of the last combined state change (boot: init time) */
+    uint32_t fault_sources;     /* bit i: STAT source i (devicetree order) reports a fault */
+    uint8_t state;              /* enum zmk_charge_indicator_state */
+    uint8_t band;               /* enum zmk_charge_indicator_band */
+    uint8_t soc;                /* battery %, as reported by ZMK */
+    uint8_t reserved;
+};
+
+/* Copy a consistent snapshot of the status. Lock-free and wait-free on a single core: callable
+ * from any context, including ISRs, at the cost of a few loads. Zeroed before the module's init.
+ */
+void zmk_charge_indicator_status_get(struct zmk_charge_indicator_status *status);
+
+/* Color argument of zmk_charge_indicator_claim_changed(): claimed, but the LEDs stay dark. */
+#define ZMK_CHARGE_INDICATOR_COLOR_OFF 0xff
+
+/* CONFIG_CHG_WIDGET_COOPERATIVE: the indicator does not write the LEDs itself; instead it calls
+ * this hook whenever it claims the LEDs, changes the claimed color, or releases them. Implement it
+ * in the LED widget; the module has no default, so a build without one fails to link:
+ * - claimed: pause the widget's own indications and show color until released.
+ * - released: resume the widget's indications.
+ * color is a code of the indicator's color table (with the led-red/green/blue aliases the bitmask
+ * red | green << 1 | blue << 2), or ZMK_CHARGE_INDICATOR_COLOR_OFF. Called from the indicator's
+ * LED thread (or its init) only on changes; must not block.
+ */
+void zmk_charge_indicator_claim_changed(bool claimed, uint8_t color);
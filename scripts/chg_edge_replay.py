@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The ZMK Contributors
+# SPDX-License-Identifier: MIT
+"""Replay recorded STAT edges and check the resulting state and LED timelines.
+
+An edge file is either the captured output of `chg edges raw` (an `hz` line
+and one hexdump line per edge, see struct chg_edge_record in src/edges.c) or
+a CSV with `t_ms,src,level` lines. A source is the custom,chg-stat instance
+index (`src=` in the boot log), not the pin: pins repeat across GPIO ports.
+
+    # Turn a field capture into shell commands that replay it on a device or native_sim:
+    python3 scripts/chg_edge_replay.py shell field.txt > replay.cmds
+    # Expected combined state transitions (reference debounce model, binary STAT inputs):
+    python3 scripts/chg_edge_replay.py expect field.txt --debounce-ms 8
+    # Compare with the `chg trace raw` capture taken after `chg edges run` (several pairs allowed):
+    python3 scripts/chg_edge_replay.py compare field.txt trace.txt [field2.txt trace2.txt ...]
+
+`compare` checks the order of the `state` trace events, and the sequence of
+LED colors written (`led_apply` / `led_off`), against the model. It exits
+non-zero if any pair mismatches, so batches of traces can be regressed from a
+shell loop. `chg edges run` clears the trace ring, so take the trace right
+after the replay. The LED model assumes the fixed-color policy (pass
+`--color any` for the battery policy) and a keyboard that stays active and
+awake during the replay.
+"""
+
+import argparse
+import csv
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import chg_trace_decode  # noqa: E402
+
+RECORD = struct.Struct("<IBBH")  # cycles, src, level, seq
+HEXDUMP_LINE = re.compile(r"^\s*[0-9a-fA-F]{8}:\s+((?:[0-9a-fA-F]{2}\s+){%d})" % RECORD.size)
+HZ_LINE = re.compile(r"\bhz (\d+)")
+STATES = chg_trace_decode.STATES
+LED_APPLY_EVENT = 1  # CHG_TR_LED_APPLY
+LED_OFF_EVENT = 2  # CHG_TR_LED_OFF
+STATE_EVENT = 6  # CHG_TR_STATE
+
+
+def read_edges(path):
+    """Return [(t_ms, src, level), ...] with t relative to the first edge."""
+    with open(path, encoding="ascii", errors="replace") as f:
+        text = f.read()
+
+    hz, raw = None, []
+    for line in text.splitlines():
+        m = HZ_LINE.search(line)
+        if m and hz is None:
+            hz = int(m.group(1))
+            continue
+        m = HEXDUMP_LINE.match(line)
+        if m:
+            raw.append(RECORD.unpack(bytes.fromhex(m.group(1))))
+
+    if raw:
+        if not hz:
+            sys.exit(f"{path}: no `hz` line")
+        t, edges = 0.0, []
+        for i, (cycles, src, level, _) in enumerate(raw):
+            if i:
+                t += ((cycles - raw[i - 1][0]) & 0xFFFFFFFF) * 1000.0 / hz
+            edges.append((t, src, level))
+        return edges
+
+    edges = []
+    for row in csv.reader(line for line in text.splitlines() if line and not line.startswith("#")):
+        if row[0].strip().lower() == "t_ms":
+            continue
+        edges.append((float(row[0]), int(row[1]), int(row[2])))
+    t0 = edges[0][0] if edges else 0.0
+    return [(t - t0, src, level) for t, src, level in edges]
+
+
+def expect(edges, debounce_ms, level_state, initial_level, combine):
+    """Reference model of the driver: per source, a level is confirmed debounce_ms after its last
+    edge; the combined state follows the combine policy. Returns combined transitions."""
+    sources = sorted({src for _, src, _ in edges})
+    confirmed = {src: level_state[initial_level] for src in sources}
+    events = []  # (t_confirm, src, level)
+    for src in sources:
+        src_edges = [(t, level) for t, s, level in edges if s == src]
+        for i, (t, level) in enumerate(src_edges):
+            if i + 1 == len(src_edges) or src_edges[i + 1][0] >= t + debounce_ms:
+                events.append((t + debounce_ms, src, level))
+    events.sort()
+
+    def combined():
+        states = [STATES.index(s) for s in confirmed.values()]
+        return STATES[min(states) if combine == "all" else max(states)]
+
+    current = combined()
+    transitions = []
+    for t, src, level in events:
+        confirmed[src] = level_state[level]
+        new = combined()
+        if new != current:
+            transitions.append((t, current, new))
+            current = new
+    return transitions
+
+
+def expect_leds(initial, transitions, colors):
+    """LED writes following the combined transitions: idle is off, other states show their color
+    ("any" for band colors). Only changes are written (and traced)."""
+    def output(state):
+        return "off" if state == "idle" else colors[state]
+
+    leds, current = [], output(initial)
+    for _, _, new in transitions:
+        if output(new) != current:
+            current = output(new)
+            leds.append(current)
+    return leds
+
+
+def trace_events(path):
+    """Return (state transitions, LED writes) of a `chg trace raw` capture."""
+    _, records = chg_trace_decode.read_capture(path)
+    states = [(STATES[a], STATES[b]) for _, event, a, b in records if event == STATE_EVENT]
+    leds = [a if event == LED_APPLY_EVENT else "off" for _, event, a, _ in records
+            if event in (LED_APPLY_EVENT, LED_OFF_EVENT)]
+    return states, leds
+
+
+def leds_match(want, got):
+    return len(got) >= len(want) and all(w == g or (w == "any" and g != "off") for w, g in zip(want, got))
+
+
+def color_arg(value):
+    return value if value == "any" else int(value, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p_shell = sub.add_parser("shell", help="print `chg edges` commands replaying an edge file")
+    p_shell.add_argument("edges")
+    p_shell.add_argument("--max-gap-ms", type=int, default=1000, help="cap for idle gaps (> debounce)")
+
+    for name in ("expect", "compare"):
+        p = sub.add_parser(name)
+        p.add_argument("files", nargs="+")
+        p.add_argument("--debounce-ms", type=float, default=8)
+        p.add_argument("--low", default="charging", choices=STATES, help="state of a low STAT level")
+        p.add_argument("--high", default="idle", choices=STATES, help="state of a high STAT level")
+        p.add_argument("--initial-level", type=int, default=1, help="level before the first edge")
+        p.add_argument("--combine", default="any", choices=["any", "all"])
+        p.add_argument("--color", type=color_arg, default=1, help="CONFIG_CHG_COLOR, or `any` (battery policy)")
+        p.add_argument("--color-complete", type=color_arg, default=2, help="CONFIG_CHG_COLOR_COMPLETE")
+        p.add_argument("--color-fault", type=color_arg, default=5, help="CONFIG_CHG_COLOR_FAULT")
+
+    args = parser.parse_args()
+
+    if args.cmd == "shell":
+        edges = read_edges(args.edges)
+        print("chg edges reset")
+        prev = 0.0
+        for t, src, level in edges:
+            print(f"chg edges push {src} {level} {int(round(t - prev))}")
+            prev = t
+        print(f"chg edges run {args.max_gap_ms}")
+        return 0
+
+    level_state = {0: args.low, 1: args.high}
+    colors = {"charging": args.color, "complete": args.color_complete, "fault": args.color_fault}
+    if args.cmd == "expect":
+        for path in args.files:
+            for t, old, new in expect(read_edges(path), args.debounce_ms, level_state, args.initial_level,
+                                      args.combine):
+                print(f"{t:>10.1f} ms  {old} -> {new}")
+        return 0
+
+    if len(args.files) % 2:
+        parser.error("compare takes EDGES TRACE pairs")
+    failed = 0
+    for edges_path, trace_path in zip(args.files[::2], args.files[1::2]):
+        transitions = expect(read_edges(edges_path), args.debounce_ms, level_state, args.initial_level,
+                             args.combine)
+        want = [(old, new) for _, old, new in transitions]
+        want_leds = expect_leds(level_state[args.initial_level], transitions, colors)
+        got, got_leds = trace_events(trace_path)
+        # The end of a replay hands the pins back, which may add transitions after the script.
+        if got[:len(want)] != want:
+            failed += 1
+            print(f"FAIL  {edges_path}: expected {want}, trace has {got}")
+        elif not leds_match(want_leds, got_leds):
+            failed += 1
+            print(f"FAIL  {edges_path}: expected LEDs {want_leds}, trace has {got_leds}")
+        else:
+            print(f"ok    {edges_path}: {len(want)} transitions, {len(want_leds)} LED changes")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
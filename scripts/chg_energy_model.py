@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The ZMK Contributors
+# SPDX-License-Identifier: MIT
+"""Estimate the energy the charge indicator spends on LEDs and CPU wakeups, per policy.
+
+Runs a model of the indicator core (state, policy, battery bands, display
+timeout, keyboard idle darkening, maintenance re-apply period) through a
+synthetic charge session and reports the charge drawn for indication. Inputs come from a small JSON file
+(scripts/energy/example.json); Kconfig values of a build (.config) and the
+color table of its zephyr.dts override the file where given:
+
+    python3 scripts/chg_energy_model.py scripts/energy/example.json
+    python3 scripts/chg_energy_model.py my_board.json --kconfig build/zephyr/.config --dts build/zephyr/zephyr.dts
+
+All current is assumed to come from the battery. While the keyboard is on USB
+the charger usually supplies it, so the result is an upper bound on battery
+drain and a direct measure of the extra load on the charger.
+
+The keyboard is taken as used at plug-in and at each user wake
+(user_wakes_per_h); with dark_on_idle (CONFIG_CHG_DARK_ON_IDLE, default on)
+the indication goes dark idle_timeout_s (CONFIG_ZMK_IDLE_TIMEOUT) later. ZMK
+does not sleep on USB power, so idle is the only darkening modeled.
+"""
+
+import argparse
+import json
+import re
+
+KCONFIG_MAP = {
+    "CONFIG_CHG_COLOR": "color",
+    "CONFIG_CHG_COLOR_COMPLETE": "color_complete",
+    "CONFIG_CHG_COLOR_FAULT": "color_fault",
+    "CONFIG_CHG_BATTERY_LEVEL_HIGH": "level_high",
+    "CONFIG_CHG_BATTERY_LEVEL_LOW": "level_low",
+    "CONFIG_CHG_BATTERY_LEVEL_CRITICAL": "level_critical",
+    "CONFIG_CHG_BATTERY_COLOR_HIGH": "band_high",
+    "CONFIG_CHG_BATTERY_COLOR_MEDIUM": "band_medium",
+    "CONFIG_CHG_BATTERY_COLOR_LOW": "band_low",
+    "CONFIG_CHG_BATTERY_COLOR_CRITICAL": "band_critical",
+    "CONFIG_CHG_BATTERY_COLOR_MISSING": "band_missing",
+}
+
+# Boolean options: (config key, value when set). Unset ones (`# CONFIG_X is not set`) read as False.
+KCONFIG_BOOL_MAP = {
+    "CONFIG_CHG_DARK_ON_IDLE": "dark_on_idle",
+    "CONFIG_CHG_POLICY": "policy_off",
+    "CONFIG_CHG_BATTERY_LEVEL_BASED_COLOR": "policy_battery",
+}
+
+
+def apply_kconfig(cfg, path):
+    c = cfg["config"]
+    flags = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            m = re.match(r"^# (CONFIG_\w+) is not set$", line)
+            if m and m.group(1) in KCONFIG_BOOL_MAP:
+                flags[KCONFIG_BOOL_MAP[m.group(1)]] = False
+                continue
+            m = re.match(r"^(CONFIG_\w+)=(\w+)$", line)
+            if not m:
+                continue
+            key, value = m.group(1), m.group(2)
+            if key in KCONFIG_BOOL_MAP:
+                flags[KCONFIG_BOOL_MAP[key]] = value == "y"
+            elif not value.isdigit():
+                continue
+            elif key in KCONFIG_MAP:
+                c[KCONFIG_MAP[key]] = int(value)
+            elif key == "CONFIG_CHG_DISPLAY_TIMEOUT_MS":
+                c["display_timeout_s"] = int(value) / 1000
+            elif key == "CONFIG_ZMK_IDLE_TIMEOUT":
+                c["idle_timeout_s"] = int(value) / 1000
+
+    if "dark_on_idle" in flags:
+        c["dark_on_idle"] = flags["dark_on_idle"]
+    # Default policy, as src/config.c picks it: off, then battery, else color.
+    if flags.get("policy_off"):
+        c["policy"] = "off"
+    elif flags.get("policy_battery"):
+        c["policy"] = "battery"
+    elif "policy_off" in flags or "policy_battery" in flags:
+        c["policy"] = "color"
+
+
+def apply_dts(cfg, path):
+    """Take the color table of the custom,charge-indicator node, if any."""
+    text = open(path).read()
+    m = re.search(r'compatible = "custom,charge-indicator";(.*?)\};', text, re.S)
+    if m:
+        colors = re.search(r"colors = <([^>]*)>;", m.group(1))
+        if colors:
+            cfg["leds"]["colors"] = [int(v, 0) for v in colors.group(1).split()]
+
+
+def color_ma(cfg, code):
+    colors = cfg["leds"]["colors"]
+    mask = colors[code] if code < len(colors) else colors[1 if len(colors) > 1 else 0]
+    return sum(ma for i, ma in enumerate(cfg["leds"]["channel_ma"]) if mask >> i & 1)
+
+
+def band(c, soc, missing):
+    if missing:
+        return c["band_missing"]
+    if soc < c["level_critical"]:
+        return c["band_critical"]
+    if soc < c["level_low"]:
+        return c["band_low"]
+    if soc < c["level_high"]:
+        return c["band_medium"]
+    return c["band_high"]
+
+
+def simulate(cfg, policy):
+    """Step through the session one second at a time. Returns (led_mAs, wakeups, lit_s)."""
+    s, c = cfg["session"], cfg["config"]
+    charge_s = s["charge_h"] * 3600
+    fault_s = s.get("fault_h", 0) * 3600
+    total_s = int(charge_s + fault_s + s["plugged_after_full_h"] * 3600)
+    timeout = c.get("display_timeout_s", 0)
+    wake_every = 3600 / c["user_wakes_per_h"] if c.get("user_wakes_per_h") else None
+    period_s = cfg["maint_period_ms"] / 1000
+    dark_on_idle = c.get("dark_on_idle", True)
+    idle_timeout = c.get("idle_timeout_s", 30)
+    missing = s.get("battery_missing", False)
+
+    led_mas, wakeups, lit_s = 0.0, 0, 0
+    shown_until = timeout  # display timeout restarts on transitions, band changes and user wakes
+    active_until = idle_timeout  # plugged in by hand: the keyboard counts as used at t = 0
+    prev_key = None
+
+    for t in range(total_s):
+        if t < charge_s:
+            soc = s["start_soc"] + (s["end_soc"] - s["start_soc"]) * t / charge_s
+            state = "charging"
+        elif t < charge_s + fault_s:
+            soc = s["end_soc"]
+            state = "fault"
+        else:
+            soc = s["end_soc"]
+            state = "complete" if s["tri_state"] else "idle"
+        soc_reported = int(soc) if t % cfg["battery_report_s"] == 0 or prev_key is None else prev_key[1]
+
+        if policy == "off" or state == "idle":
+            code = None
+        elif state == "complete":
+            code = c["color_complete"]
+        elif state == "fault":
+            code = c["color_fault"]
+        elif policy == "battery":
+            code = band(c, soc_reported, missing)
+        else:
+            code = c["color"]
+
+        key = (state, soc_reported, code)
+        if prev_key is None or key[0] != prev_key[0] or key[2] != prev_key[2]:
+            shown_until = t + timeout
+        if wake_every and t % int(wake_every) == 0 and t:
+            shown_until = t + timeout
+            active_until = t + idle_timeout
+        prev_key = key
+
+        if t % cfg["battery_report_s"] == 0 and state != "idle":
+            wakeups += 1  # battery event listener
+
+        dark = dark_on_idle and t >= active_until  # idle keyboard: no LEDs, no re-applies
+        displaying = state != "idle" and not dark and (not timeout or t < shown_until)
+        if displaying:
+            wakeups += 1 / period_s  # maintenance re-apply (policy off re-applies "off" too)
+            if code is not None:
+                led_mas += color_ma(cfg, code)
+                lit_s += 1
+
+    return led_mas, wakeups, lit_s
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("config", help="model config (JSON)")
+    parser.add_argument("--kconfig", help="build/zephyr/.config to take CHG_* values from")
+    parser.add_argument("--dts", help="build/zephyr/zephyr.dts to take the color table from")
+    parser.add_argument("--policy", action="append", choices=["color", "battery", "off"])
+    args = parser.parse_args()
+
+    with open(args.config) as f:
+        cfg = json.load(f)
+    if args.kconfig:
+        apply_kconfig(cfg, args.kconfig)
+    if args.dts:
+        apply_dts(cfg, args.dts)
+
+    w = cfg["wakeup"]
+    wake_mas = w["current_ma"] * w["duration_us"] / 1e6
+    s, c = cfg["session"], cfg["config"]
+    hours = s["charge_h"] + s.get("fault_h", 0) + s["plugged_after_full_h"]
+
+    print(f"session: {s['start_soc']}% -> {s['end_soc']}% in {s['charge_h']} h, plugged {hours} h total, "
+          f"display timeout {c.get('display_timeout_s', 0)} s")
+    if c.get("dark_on_idle", True):
+        print(f"keyboard: dark on idle, {c.get('idle_timeout_s', 30)} s after plug-in and each of "
+              f"{c.get('user_wakes_per_h', 0)} user wakes per hour")
+    else:
+        print("keyboard: lit while idle (dark_on_idle off)")
+    print(f"{'policy':<8} {'LED mAh':>9} {'wake mAh':>9} {'total mAh':>10} {'avg uA':>8} {'lit h':>7} {'wakeups':>9}")
+    for policy in args.policy or cfg["policies"]:
+        led_mas, wakeups, lit_s = simulate(cfg, policy)
+        led_mah = led_mas / 3600
+        wake_mah = wakeups * wake_mas / 3600
+        total = led_mah + wake_mah
+        default = "  (default)" if policy == c.get("policy") else ""
+        print(f"{policy:<8} {led_mah:>9.3f} {wake_mah:>9.4f} {total:>10.3f} {total / hours * 1000:>8.1f} "
+              f"{lit_s / 3600:>7.2f} {int(wakeups):>9}{default}")
+
+
+if __name__ == "__main__":
+    main()
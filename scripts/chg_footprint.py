@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The ZMK Contributors
+# SPDX-License-Identifier: MIT
+"""Measure the ROM/RAM cost of the charge indicator across a configuration matrix.
+
+Builds the ZMK app once per target and matrix entry (scripts/footprint/matrix.json)
+with this module as an extra module, then compares the symbols of every variant's
+zephyr.elf against the baseline build (indicator disabled), or against the variant
+named by its "against" key, so one option's own cost is measured on top of the default
+configuration. A variant with "targets" is only built for those targets, and "modules"
+names extra Zephyr modules under scripts/footprint (e.g. a widget hook). Needs a west
+workspace with ZMK and the Zephyr SDK; run it from anywhere:
+
+    python3 scripts/chg_footprint.py --zmk-app ~/zmk/app
+    python3 scripts/chg_footprint.py --zmk-app ~/zmk/app --target nice_nano_v2:corne_left --symbols 15
+    python3 scripts/chg_footprint.py --no-build          # re-analyze existing builds
+
+A target is BOARD or BOARD:SHIELD. ROM counts text, rodata and initialized data;
+RAM counts data and bss (so initialized data is in both, as in the linker map).
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+from pathlib import Path
+
+MODULE_DIR = Path(__file__).resolve().parent.parent
+FOOTPRINT_DIR = MODULE_DIR / "scripts" / "footprint"
+
+ROM_TYPES = set("tTrRdD")
+RAM_TYPES = set("dDbBvV")
+
+
+def build(args, target, name, entry):
+    board, _, shield = target.partition(":")
+    build_dir = Path(args.build_dir) / target.replace("/", "_").replace(":", "-") / name
+    conf = build_dir.parent / f"{name}.conf"
+    build_dir.parent.mkdir(parents=True, exist_ok=True)
+    conf.write_text("".join(f"{k}={v}\n" for k, v in entry.get("conf", {}).items()))
+
+    overlays = ";".join(str(FOOTPRINT_DIR / o) for o in entry.get("overlays", []))
+    modules = ";".join([str(MODULE_DIR)] + [str(FOOTPRINT_DIR / m) for m in entry.get("modules", [])])
+    cmd = ["west", "build", "-s", args.zmk_app, "-d", str(build_dir), "-b", board, "--",
+           f"-DZMK_EXTRA_MODULES={modules}", f"-DEXTRA_CONF_FILE={conf}"]
+    if overlays:
+        cmd.append(f"-DEXTRA_DTC_OVERLAY_FILE={overlays}")
+    if shield:
+        cmd.append(f"-DSHIELD={shield}")
+
+    print(f"== {target} / {name}", file=sys.stderr)
+    subprocess.run(cmd, check=True, stdout=None if args.verbose else subprocess.DEVNULL)
+    return build_dir
+
+
+def nm_tool(build_dir):
+    cache = (build_dir / "CMakeCache.txt").read_text()
+    m = re.search(r"^CMAKE_NM:\w+=(.+)$", cache, re.M)
+    return m.group(1) if m else "nm"
+
+
+def symbols(build_dir):
+    """Return {symbol: (type, size)} of zephyr.elf."""
+    out = subprocess.run([nm_tool(build_dir), "--print-size", "--size-sort", str(build_dir / "zephyr" / "zephyr.elf")],
+                         check=True, capture_output=True, text=True).stdout
+    syms = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) != 4:
+            continue
+        _, size, kind, name = parts
+        key = name
+        while key in syms:  # static symbols may repeat across files
+            key += "'"
+        syms[key] = (kind, int(size, 16))
+    return syms
+
+
+def totals(syms):
+    rom = sum(size for kind, size in syms.values() if kind in ROM_TYPES)
+    ram = sum(size for kind, size in syms.values() if kind in RAM_TYPES)
+    return rom, ram
+
+
+def diff(base, var):
+    rows = []
+    for name in set(base) | set(var):
+        bk, bs = base.get(name, ("", 0))
+        vk, vs = var.get(name, ("", 0))
+        if bs != vs:
+            kind = vk or bk
+            rows.append((name, kind, vs - bs))
+    rows.sort(key=lambda r: -abs(r[2]))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--zmk-app", help="path to zmk/app (required unless --no-build)")
+    parser.add_argument("--matrix", default=str(FOOTPRINT_DIR / "matrix.json"))
+    parser.add_argument("--target", action="append", help="BOARD[:SHIELD], overrides the matrix targets")
+    parser.add_argument("--only", action="append", help="build only these variants")
+    parser.add_argument("--build-dir", default="_footprint")
+    parser.add_argument("--no-build", action="store_true", help="analyze existing builds only")
+    parser.add_argument("--symbols", type=int, default=0, help="list the N largest symbol deltas per variant")
+    parser.add_argument("--json", action="store_true", help="print results as JSON")
+    parser.add_argument("-v", "--verbose", action="store_true", help="show build output")
+    args = parser.parse_args()
+
+    if not args.no_build and not args.zmk_app:
+        parser.error("--zmk-app is required to build")
+
+    matrix = json.loads(Path(args.matrix).read_text())
+    targets = args.target or matrix["targets"]
+    variants = {k: v for k, v in matrix["variants"].items() if not args.only or k in args.only}
+
+    entries = dict(matrix["variants"], baseline=matrix["baseline"])
+    results = {}
+    for target in targets:
+        tdir = Path(args.build_dir) / target.replace("/", "_").replace(":", "-")
+        built = {}
+
+        def syms_of(name):
+            """Symbols of one entry, built on first use (reference entries included)."""
+            if name not in built:
+                var_dir = tdir / name if args.no_build else build(args, target, name, entries[name])
+                built[name] = symbols(var_dir)
+            return built[name]
+
+        base_rom, base_ram = totals(syms_of("baseline"))
+        results[target] = {"baseline": {"rom": base_rom, "ram": base_ram}, "variants": {}}
+
+        for name, entry in variants.items():
+            if "targets" in entry and target not in entry["targets"]:
+                continue
+            against = entry.get("against", "baseline")
+            ref, var = syms_of(against), syms_of(name)
+            ref_rom, ref_ram = totals(ref)
+            rom, ram = totals(var)
+            rows = diff(ref, var)
+            results[target]["variants"][name] = {
+                "against": against,
+                "rom": rom - ref_rom,
+                "ram": ram - ref_ram,
+                "symbols": [{"name": n.rstrip("'"), "type": k, "delta": d} for n, k, d in rows[:args.symbols]],
+            }
+
+    if args.json:
+        json.dump(results, sys.stdout, indent=2)
+        print()
+        return
+
+    for target, res in results.items():
+        print(f"\n{target}  (baseline ROM {res['baseline']['rom']} B, RAM {res['baseline']['ram']} B)")
+        print(f"  {'variant':<16} {'ROM':>8} {'RAM':>8}  against")
+        for name, v in res["variants"].items():
+            print(f"  {name:<16} {v['rom']:>+8} {v['ram']:>+8}  {v['against']}")
+            for s in v["symbols"]:
+                print(f"      {s['delta']:>+7}  {s['type']}  {s['name']}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The ZMK Contributors
+# SPDX-License-Identifier: MIT
+"""Decode charge session journal records.
+
+Input is either the captured output of the `chg journal raw` shell command
+(one hexdump line per record) or a binary file of concatenated records.
+The record layout must match struct chg_journal_record in src/journal.c.
+
+    python3 scripts/chg_journal_decode.py capture.txt [--csv]
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+RECORD = struct.Struct("<HHIIBBBB")  # seq, boot, start_s, duration_s, start_soc, end_soc, flags, version
+FLAGS = {0x01: "complete", 0x02: "fault", 0x04: "warm"}
+HEXDUMP_LINE = re.compile(r"^\s*[0-9a-fA-F]{8}:\s+((?:[0-9a-fA-F]{2}\s+){%d})" % RECORD.size)
+
+
+def read_records(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    try:
+        text = data.decode("ascii")
+    except UnicodeDecodeError:
+        text = None
+
+    matches = [HEXDUMP_LINE.match(line) for line in text.splitlines()] if text is not None else []
+    if any(matches):
+        for m in filter(None, matches):
+            yield RECORD.unpack(bytes.fromhex(m.group(1)))
+        return
+
+    for off in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        yield RECORD.unpack_from(data, off)
+
+
+def describe_flags(flags):
+    names = [name for bit, name in FLAGS.items() if flags & bit]
+    return "|".join(names) if names else "-"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="`chg journal raw` capture or binary record file")
+    parser.add_argument("--csv", action="store_true", help="print CSV instead of a table")
+    args = parser.parse_args()
+
+    if args.csv:
+        print("seq,boot,start_s,duration_s,start_soc,end_soc,flags,version")
+    else:
+        print(f"{'seq':>5} {'boot':>5} {'start':>9} {'duration':>9} {'soc':>9}  flags")
+
+    for seq, boot, start_s, duration_s, start_soc, end_soc, flags, version in read_records(args.input):
+        if version != 1:
+            print(f"warning: record {seq} has unknown version {version}", file=sys.stderr)
+        if args.csv:
+            print(f"{seq},{boot},{start_s},{duration_s},{start_soc},{end_soc},{describe_flags(flags)},{version}")
+        else:
+            h, rem = divmod(duration_s, 3600)
+            print(f"{seq:>5} {boot:>5} {start_s:>8}s {h:>3}h{rem // 60:02d}m{rem % 60:02d}s "
+                  f"{start_soc:>3}%->{end_soc:>3}%  {describe_flags(flags)}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The ZMK Contributors
+# SPDX-License-Identifier: MIT
+"""Decode charge indicator trace records.
+
+Input is the captured output of the `chg trace raw` shell command: an
+`hz <cycles per second>` line followed by one hexdump line per record.
+The record layout and event ids must match struct chg_trace_record in
+src/trace.c and enum chg_trace_event in src/charge_indicator.h.
+
+    python3 scripts/chg_trace_decode.py capture.txt [--csv]
+"""
+
+import argparse
+import re
+import struct
+
+RECORD = struct.Struct("<IBBH")  # cycles, event, a, b
+HEXDUMP_LINE = re.compile(r"^\s*[0-9a-fA-F]{8}:\s+((?:[0-9a-fA-F]{2}\s+){%d})" % RECORD.size)
+HZ_LINE = re.compile(r"\bhz (\d+)")
+
+STATES = ["idle", "complete", "charging", "fault"]
+ACTIVITY = ["active", "idle", "sleep"]
+
+
+def state(v):
+    return STATES[v] if v < len(STATES) else str(v)
+
+
+# event id: (name, formatter of a, b)
+EVENTS = {
+    1: ("led_apply", lambda a, b: f"color {a}"),
+    2: ("led_off", lambda a, b: ""),
+    3: ("band", lambda a, b: f"color {a} at {b}%"),
+    4: ("stat_edge", lambda a, b: f"src {a}"),
+    5: ("stat_confirm", lambda a, b: f"src/code {a} -> {state(b)}"),
+    6: ("state", lambda a, b: f"{state(a)} -> {state(b)}"),
+    7: ("show_battery", lambda a, b: ""),
+    8: ("readout", lambda a, b: f"{a}%"),
+    9: ("display", lambda a, b: "wake" if a else "timeout"),
+    10: ("activity", lambda a, b: ACTIVITY[a] if a < len(ACTIVITY) else str(a)),
+    11: ("isr_enter", lambda a, b: f"src {a}"),
+    12: ("isr_exit", lambda a, b: f"src {a}"),
+    13: ("override", lambda a, b: f"source {a} ({state(b)}) outvoted"),
+}
+
+
+def read_capture(path):
+    """Return (hz, [(cycles, event, a, b), ...]) in capture order."""
+    hz = None
+    records = []
+    with open(path, encoding="ascii", errors="replace") as f:
+        for line in f:
+            m = HZ_LINE.search(line)
+            if m and hz is None:
+                hz = int(m.group(1))
+                continue
+            m = HEXDUMP_LINE.match(line)
+            if m:
+                records.append(RECORD.unpack(bytes.fromhex(m.group(1))))
+    return hz, records
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="`chg trace raw` capture")
+    parser.add_argument("--hz", type=int, help="cycle counter frequency if the capture has no hz line")
+    parser.add_argument("--csv", action="store_true", help="print CSV instead of a table")
+    args = parser.parse_args()
+
+    hz, records = read_capture(args.input)
+    hz = args.hz or hz
+    if not hz:
+        parser.error("no `hz` line in the capture; pass --hz")
+
+    if args.csv:
+        print("t_us,event,a,b")
+    t0 = records[0][0] if records else 0
+    for cycles, event, a, b in records:
+        # 32-bit cycle counter: differences stay correct across one wrap.
+        t_us = ((cycles - t0) & 0xFFFFFFFF) * 1_000_000 // hz
+        name, fmt = EVENTS.get(event, (f"event{event}", lambda a, b: f"a={a} b={b}"))
+        if args.csv:
+            print(f"{t_us},{name},{a},{b}")
+        else:
+            print(f"{t_us:>12} us  {name:<13} {fmt(a, b)}")
+
+
+if __name__ == "__main__":
+    main()
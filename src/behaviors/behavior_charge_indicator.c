@@ -0,0 +1,66 @@
+// src/behaviors/behavior_charge_indicator.c
+//
+// ZMK behavior controlling the charge indicator from the keymap (&chg_ind CHG_IND_*).
+// - Updates the runtime configuration; the LEDs are refreshed once from a work item and the
+//   change is saved debounced (src/config.c).
+// - Global locality: on split keyboards each half applies it to its own indicator.
+//
+
+#define DT_DRV_COMPAT zmk_behavior_charge_indicator
+
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include <drivers/behavior.h>
+#include <dt-bindings/zmk/charge_indicator.h>
+#include <zmk/behavior.h>
+
+#include "../charge_indicator.h"
+
+LOG_MODULE_DECLARE(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
+
+static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
+                                     struct zmk_behavior_binding_event event)
+{
+    switch (binding->param1) {
+    case CHG_IND_TOG:
+        chg_cfg.enabled = !chg_cfg.enabled;
+        break;
+    case CHG_IND_OFF:
+        chg_cfg.enabled = false;
+        break;
+    case CHG_IND_ON:
+        chg_cfg.enabled = true;
+        break;
+    case CHG_IND_NEXT_POLICY:
+        chg_cfg.policy = (chg_cfg.policy + 1) % CHG_POLICY_COUNT;
+        break;
+    case CHG_IND_SHOW_BAT:
+#if IS_ENABLED(CONFIG_CHG_READOUT)
+        chg_readout_start();
+#else
+        chg_show_battery();
+#endif
+        return ZMK_BEHAVIOR_OPAQUE;
+    default:
+        LOG_ERR("Unknown charge indicator command: %d", binding->param1);
+        return -ENOTSUP;
+    }
+
+    chg_config_changed();
+    return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event)
+{
+    return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static const struct behavior_driver_api behavior_charge_indicator_driver_api = {
+    .binding_pressed = on_keymap_binding_pressed,
+    .binding_released = on_keymap_binding_released,
+    .locality = BEHAVIOR_LOCALITY_GLOBAL,
+};
+
+BEHAVIOR_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL,
+                        CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &behavior_charge_indicator_driver_api);
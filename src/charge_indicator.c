@@ -1,173 +1,626 @@
 // src/charge_indicator.c
 //
 // ZMK Feature: Charge Indicator (DT-driven, rgbled_adapter optional)
-// - Reads charging status from a DT-defined chg_stat node (raw GPIO level: 0 = charging).
-// - During charging, suppress widget output and either show a selected color or force LEDs OFF (Kconfig).
+// - Reads charging status from one or more DT-defined custom,chg-stat devices (raw GPIO level: 0 = charging)
+//   and combines them (any/all/priority) in a single deferred evaluation.
+// - During charging, suppress widget output and either show a selected color or force LEDs OFF
+//   (runtime policy, Kconfig defaults, persisted through settings).
+// - Tri-state STAT inputs additionally report charge complete and fault, each with its own color.
 // - When not charging, keep LEDs OFF and let rgbled_widget handle all LED indications (no shortened durations).
-// - Works with rgbled_adapter OR with custom DT that defines led-red/green/blue aliases; if aliases are absent, LED control is skipped safely.
+// - LED channels come from a custom,charge-indicator node (1..8 LEDs, DT color table) or the
+//   led-red/green/blue aliases (rgbled_adapter); if neither exists, LED control is skipped safely.
 // - Split-friendly: run the same code on both halves; each side reads and shows its own charging state.
 // - No heap usage: uses a static thread to gently re-apply charging state only while charging.
+// - That thread is the LED actor: the only writer of the LEDs after init. Every other context
+//   (STAT work, listeners, behavior, readout) posts a small message and never touches a GPIO.
+// - System sleep (PM notifier, ZMK sleep): LED pins are released and STAT inputs armed as wake sources.
+// - CONFIG_CHG_WIDGET_COOPERATIVE: no GPIO writes and no periodic re-apply; LED claims are handed
+//   to the widget through zmk_charge_indicator_claim_changed(), which renders them itself (the
+//   widget implements it; no LED nodes are needed, and a missing hook fails to link).
+// - Status snapshot for other modules (zmk_charge_indicator_status_get()), published by the actor.
 //
 
+#include <stdlib.h>
+#include <string.h>
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
-#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/hwinfo.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/pm/pm.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
 #include <zmk/battery.h>
 #include <zmk/event_manager.h>
+#include <zmk/events/activity_state_changed.h>
 #include <zmk/events/battery_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/pm.h>
+#include <zmk_charge_indicator/charge_indicator.h>
+
+#include "charge_indicator.h"
 
 LOG_MODULE_REGISTER(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
 
 
-/* Devicetree: Resolve charging status input from a chg_stat node via alias.
- * DT must provide:
- *   - a node: chg_stat: chg_stat { gpios = <&gpioX PIN GPIO_ACTIVE_LOW>; status = "okay"; };
+/* Devicetree: charging status comes from one or more custom,chg-stat nodes, e.g.
+ *   chg_stat: chg_stat { compatible = "custom,chg-stat"; gpios = <&gpioX PIN GPIO_ACTIVE_LOW>; };
+ * or custom,chg-stat-input nodes consuming a gpio-keys key.
+ * Each node is its own device (src/chg_stat.c, src/chg_stat_input.c); this file combines their states.
  */
-#define CHG_NODE        DT_NODELABEL(chg_stat)
-#if !DT_NODE_HAS_STATUS(CHG_NODE, okay)
-#error "DT alias chg-stat not found or not okay. Define aliases { chg-stat = &chg_stat; } and a chg_stat node."
+#if !DT_HAS_COMPAT_STATUS_OKAY(custom_chg_stat) && !DT_HAS_COMPAT_STATUS_OKAY(custom_chg_stat_input)
+#error "No custom,chg-stat node found or not okay. Define a chg_stat node with compatible \"custom,chg-stat\"."
 #endif
 
-#define CHG_CTLR        DT_GPIO_CTLR_BY_IDX(CHG_NODE, gpios, 0)
-#define CHG_PIN_NUM     DT_GPIO_PIN_BY_IDX(CHG_NODE, gpios, 0)
-/* Input flags:
- * - Use pull-up to keep the line high when PMIC STAT is open-drain (not charging).
- * - Do NOT set ACTIVE_LOW for input; we read raw level and treat 0 as charging consistently.
+/* STAT sources in DT order, with their combine priority. */
+struct chg_source {
+    const struct device *dev;
+    int priority;
+};
+
+#define CHG_SOURCE(node_id) { .dev = DEVICE_DT_GET(node_id), .priority = DT_PROP(node_id, priority) },
+
+static const struct chg_source chg_sources[] = {
+    DT_FOREACH_STATUS_OKAY(custom_chg_stat, CHG_SOURCE)
+    IF_ENABLED(CONFIG_CHG_STAT_INPUT, (DT_FOREACH_STATUS_OKAY(custom_chg_stat_input, CHG_SOURCE)))
+};
+
+#if IS_ENABLED(CONFIG_PM_DEVICE)
+/* STAT devices suspended ahead of soft off (keyboard SLEEP), or for a deep PM state. */
+static atomic_t sources_suspended;
+
+/* Suspend the STAT devices: wakeup sources arm a level interrupt for the opposite level.
+ * zmk_pm_soft_off() cannot be relied on for that: it disables wakeup on every device, suspends
+ * the ones left without it and powers off without PM notifiers. Run before it, while the
+ * devicetree (or runtime) wakeup setting still holds; soft off then finds the devices suspended
+ * and leaves them alone.
  */
-#define CHG_PIN_FLAGS   (GPIO_INPUT | GPIO_PULL_UP)
+static void sources_suspend(void)
+{
+    if (atomic_set(&sources_suspended, 1)) {
+        return;
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(chg_sources); i++) {
+        (void)pm_device_action_run(chg_sources[i].dev, PM_DEVICE_ACTION_SUSPEND);
+    }
+}
 
-/* Resolve RGB LED aliases, either provided by rgbled_adapter or your custom DT overlay.
- * If aliases are missing, we skip LED control entirely and let rgbled_widget (or others) use LEDs freely.
+/* Back to edge interrupts; each device re-reads its line. */
+static void sources_resume(void)
+{
+    if (!atomic_clear(&sources_suspended)) {
+        return;
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(chg_sources); i++) {
+        (void)pm_device_action_run(chg_sources[i].dev, PM_DEVICE_ACTION_RESUME);
+    }
+}
+#else
+static inline void sources_suspend(void) {}
+static inline void sources_resume(void) {}
+#endif
+
+/* State: combined charging state of all sources (enum chg_state). */
+static atomic_t cur_state = ATOMIC_INIT(CHG_STATE_IDLE);
+static bool chg_ready;
+/* Status snapshot inputs: uptime of the last combined transition, sources reporting a fault. */
+static atomic_t transition_ms;
+static atomic_t fault_sources;
+/* On-demand battery level display (behavior), overrides the state while set. */
+static atomic_t show_battery;
+
+/* Whether the indicator owns the LEDs (and suppresses the widget) in this state. */
+static inline bool claims_leds(enum chg_state state)
+{
+    return atomic_get(&show_battery) || chg_readout_active() ||
+           (chg_cfg.enabled && state != CHG_STATE_IDLE);
+}
+
+#if CONFIG_CHG_DISPLAY_TIMEOUT_MS > 0
+/* Display timeout: set once the indication has been shown for CONFIG_CHG_DISPLAY_TIMEOUT_MS
+ * since the last transition, band change or user wake; the LEDs are then held off.
  */
-#define LED_RED_ALIAS    DT_ALIAS(led_red)
-#define LED_GREEN_ALIAS  DT_ALIAS(led_green)
-#define LED_BLUE_ALIAS   DT_ALIAS(led_blue)
-
-#if DT_NODE_HAS_STATUS(LED_RED_ALIAS, okay) && \
-    DT_NODE_HAS_STATUS(LED_GREEN_ALIAS, okay) && \
-    DT_NODE_HAS_STATUS(LED_BLUE_ALIAS, okay)
-  /* Aliases present: enable LED control. */
-  #define LEDR_CTLR   DT_GPIO_CTLR_BY_IDX(LED_RED_ALIAS, gpios, 0)
-  #define LEDR_PIN    DT_GPIO_PIN_BY_IDX(LED_RED_ALIAS, gpios, 0)
-  #define LEDR_FLAGS  (DT_GPIO_FLAGS_BY_IDX(LED_RED_ALIAS, gpios, 0) | GPIO_OUTPUT)
-
-  #define LEDG_CTLR   DT_GPIO_CTLR_BY_IDX(LED_GREEN_ALIAS, gpios, 0)
-  #define LEDG_PIN    DT_GPIO_PIN_BY_IDX(LED_GREEN_ALIAS, gpios, 0)
-  #define LEDG_FLAGS  (DT_GPIO_FLAGS_BY_IDX(LED_GREEN_ALIAS, gpios, 0) | GPIO_OUTPUT)
-
-  #define LEDB_CTLR   DT_GPIO_CTLR_BY_IDX(LED_BLUE_ALIAS, gpios, 0)
-  #define LEDB_PIN    DT_GPIO_PIN_BY_IDX(LED_BLUE_ALIAS, gpios, 0)
-  #define LEDB_FLAGS  (DT_GPIO_FLAGS_BY_IDX(LED_BLUE_ALIAS, gpios, 0) | GPIO_OUTPUT)
+static atomic_t display_expired;
+
+static void chg_display_timeout(struct k_work *work)
+{
+    CHG_TRACE(CHG_TR_DISPLAY, 0, 0);
+    atomic_set(&display_expired, 1);
+    chg_refresh();
+}
+
+static K_WORK_DELAYABLE_DEFINE(chg_display_work, chg_display_timeout);
+
+static inline bool display_is_expired(void)
+{
+    return atomic_get(&display_expired);
+}
+
+/* Show the indication again and restart the timeout. */
+static void display_wake(void)
+{
+    CHG_TRACE(CHG_TR_DISPLAY, 1, 0);
+    atomic_clear(&display_expired);
+    k_work_reschedule(&chg_display_work, K_MSEC(CONFIG_CHG_DISPLAY_TIMEOUT_MS));
+}
 #else
-  /* No LED aliases: disable LED control (always delegate to widget/other features). */
-  #define CHARGE_INDICATOR_DISABLE_LED 1
+static inline bool display_is_expired(void) { return false; }
+static inline void display_wake(void) {}
 #endif
 
-/* State and devices */
-static atomic_t is_charging = ATOMIC_INIT(false);
-static const struct device *chg_dev;
-#ifndef CHARGE_INDICATOR_DISABLE_LED
-static const struct device *ledr_dev, *ledg_dev, *ledb_dev;
+/* The module drives the LED GPIOs itself (channels exist and no cooperative widget renders). */
+#if !defined(CHARGE_INDICATOR_DISABLE_LED) && !IS_ENABLED(CONFIG_CHG_WIDGET_COOPERATIVE)
+  #define CHG_LED_DIRECT 1
 #endif
-static struct gpio_callback chg_cb;
+
+/* The indication goes somewhere: to the LED GPIOs, or to the cooperating widget. */
+#if defined(CHG_LED_DIRECT) || IS_ENABLED(CONFIG_CHG_WIDGET_COOPERATIVE)
+  #define CHG_LED_OUTPUT 1
+#endif
+
+/* Keyboard activity: dark while the keyboard sleeps (or idles, CONFIG_CHG_DARK_ON_IDLE). */
+static atomic_t kbd_dark;
+/* System sleep: LED pins released, nothing is applied until resume. */
+static atomic_t chg_suspended;
+
+/* Whether the maintenance thread has to keep re-applying the LEDs. The readout drives the
+ * LEDs itself; an expired display or a sleeping keyboard is held off without periodic work.
+ */
+static inline bool display_active(enum chg_state state)
+{
+    if (IS_ENABLED(CONFIG_CHG_WIDGET_COOPERATIVE)) {
+        return false; /* the widget keeps what it was told; nothing to suppress */
+    }
+    if (chg_readout_active() || atomic_get(&kbd_dark) || atomic_get(&chg_suspended)) {
+        return false;
+    }
+    return atomic_get(&show_battery) || (claims_leds(state) && !display_is_expired());
+}
 
 /* Maintenance thread: reapply charging state periodically to suppress widget while charging. */
-K_THREAD_STACK_DEFINE(chg_maint_stack, 512);
+K_THREAD_STACK_DEFINE(chg_maint_stack, CONFIG_CHG_MAINT_STACK_SIZE);
 static struct k_thread chg_maint_thread;
+static k_tid_t chg_maint_tid;
 
-/* Common-anode RGB (gpio-leds with GPIO_ACTIVE_LOW): write logical 1 to turn LED ON. */
-#ifndef CHARGE_INDICATOR_DISABLE_LED
-static inline void led_red(bool on)   { gpio_pin_set(ledr_dev, LEDR_PIN, on ? 1 : 0); }
-static inline void led_green(bool on) { gpio_pin_set(ledg_dev, LEDG_PIN, on ? 1 : 0); }
-static inline void led_blue(bool on)  { gpio_pin_set(ledb_dev, LEDB_PIN, on ? 1 : 0); }
+/* LED actor messages. Re-applying the state is a flag (any number of requests coalesce into
+ * one apply); the message only wakes the actor, so a full queue never loses it.
+ */
+enum chg_led_op {
+    CHG_LED_OP_APPLY,       /* apply the current state */
+    CHG_LED_OP_SHOW,        /* readout pulse: color code or CHG_LED_SHOW_OFF */
+    CHG_LED_OP_STATUS,      /* republish the status snapshot only (LEDs untouched) */
+    CHG_LED_OP_SUSPEND,     /* LEDs off, pins released; gives chg_suspend_done */
+};
+
+struct chg_led_msg {
+    uint8_t op;
+    uint8_t color;
+};
+
+static K_MSGQ_DEFINE(chg_led_msgq, sizeof(struct chg_led_msg), 8, 1);
+static atomic_t apply_pending;
+static K_SEM_DEFINE(chg_suspend_done, 0, 1);
+
+/* Bound on waiting for the actor to release the LEDs before sleep. */
+#define CHG_SUSPEND_WAIT    K_MSEC(100)
+
+static inline void led_post(uint8_t op, uint8_t color)
+{
+    struct chg_led_msg msg = { .op = op, .color = color };
+
+    /* Never blocks; on overflow a pulse is dropped and a pending apply stays flagged. */
+    (void)k_msgq_put(&chg_led_msgq, &msg, K_NO_WAIT);
+}
 
-/* Apply LED color based on color code (0-7). */
-static inline void apply_color_code(int color)
+void chg_refresh(void)
 {
-    LOG_DBG("Applying color code: %d", color);
-    switch (color) {
-        case 0: /* Black(off) */             led_red(false); led_green(false); led_blue(false); break;
-        case 1: /* Red */                    led_red(true);  led_green(false); led_blue(false); break;
-        case 2: /* Green */                  led_red(false); led_green(true);  led_blue(false); break;
-        case 3: /* Yellow(R+G) */            led_red(true);  led_green(true);  led_blue(false); break;
-        case 4: /* Blue */                   led_red(false); led_green(false); led_blue(true);  break;
-        case 5: /* Magenta(R+B) */           led_red(true);  led_green(false); led_blue(true);  break;
-        case 6: /* Cyan(G+B) */              led_red(false); led_green(true);  led_blue(true);  break;
-        case 7: /* White(R+G+B) */           led_red(true);  led_green(true);  led_blue(true);  break;
-        default: /* Fallback Red */          led_red(true);  led_green(false); led_blue(false); break;
+    if (!atomic_set(&apply_pending, 1)) {
+        led_post(CHG_LED_OP_APPLY, 0);
     }
 }
 
+void chg_led_show(uint8_t color)
+{
+    led_post(CHG_LED_OP_SHOW, color);
+}
+
+/* Battery level band (enum zmk_charge_indicator_band) of a battery %. */
+static uint8_t battery_band(uint8_t battery_pct)
+{
+    if (battery_pct > 100) {
+        return ZMK_CHARGE_INDICATOR_BAND_MISSING;
+    } else if (battery_pct < chg_cfg.level_critical) {
+        return ZMK_CHARGE_INDICATOR_BAND_CRITICAL;
+    } else if (battery_pct < chg_cfg.level_low) {
+        return ZMK_CHARGE_INDICATOR_BAND_LOW;
+    } else if (battery_pct < chg_cfg.level_high) {
+        return ZMK_CHARGE_INDICATOR_BAND_MEDIUM;
+    }
+    return ZMK_CHARGE_INDICATOR_BAND_HIGH;
+}
+
+#ifdef CHG_LED_OUTPUT
 /* Get battery level based color code. */
-#if IS_ENABLED(CONFIG_CHG_BATTERY_LEVEL_BASED_COLOR)
 static int get_battery_level_color(void)
 {
     uint8_t battery_pct = zmk_battery_state_of_charge();
-    LOG_DBG("Battery level: %d%%", battery_pct);
+    uint8_t band;
+
+    switch (battery_band(battery_pct)) {
+    case ZMK_CHARGE_INDICATOR_BAND_MISSING:  band = chg_cfg.band_missing; break;
+    case ZMK_CHARGE_INDICATOR_BAND_CRITICAL: band = chg_cfg.band_critical; break;
+    case ZMK_CHARGE_INDICATOR_BAND_LOW:      band = chg_cfg.band_low; break;
+    case ZMK_CHARGE_INDICATOR_BAND_MEDIUM:   band = chg_cfg.band_medium; break;
+    default:                                 band = chg_cfg.band_high; break;
+    }
 
-    if (battery_pct < 0 || battery_pct > 100) {
-        return CONFIG_CHG_BATTERY_COLOR_MISSING;
+#if CHG_TRACE_ENABLED
+    /* Called on every re-apply: trace changes only. */
+    static uint8_t traced_band = UINT8_MAX, traced_pct = UINT8_MAX;
+    if (band != traced_band || battery_pct != traced_pct) {
+        traced_band = band;
+        traced_pct = battery_pct;
+        CHG_TRACE(CHG_TR_BAND, band, battery_pct);
     }
+#endif
+    return band;
+}
+#endif
+
+#ifdef CHG_LED_OUTPUT
+BUILD_ASSERT(CHG_LED_SHOW_OFF == ZMK_CHARGE_INDICATOR_COLOR_OFF, "dark color codes differ");
 
-    if (battery_pct < CONFIG_CHG_BATTERY_LEVEL_CRITICAL) {
-        return CONFIG_CHG_BATTERY_COLOR_CRITICAL;
-    } else if (battery_pct < CONFIG_CHG_BATTERY_LEVEL_LOW) {
-        return CONFIG_CHG_BATTERY_COLOR_LOW;
-    } else if (battery_pct < CONFIG_CHG_BATTERY_LEVEL_HIGH) {
-        return CONFIG_CHG_BATTERY_COLOR_MEDIUM;
+#if IS_ENABLED(CONFIG_CHG_WIDGET_COOPERATIVE)
+/* LED output: tell the widget about claim and color changes only (actor or init). */
+static void led_claim(bool claimed, uint8_t color)
+{
+    static bool last_claimed;
+    static uint8_t last_color = CHG_LED_SHOW_OFF;
+
+    if (!claimed) {
+        color = CHG_LED_SHOW_OFF;
+    }
+    if (claimed == last_claimed && color == last_color) {
+        return;
+    }
+    last_claimed = claimed;
+    last_color = color;
+    zmk_charge_indicator_claim_changed(claimed, color);
+}
+#else
+/* LED output: claimed with a color code (CHG_LED_SHOW_OFF: dark), or handed back dark. */
+static void led_claim(bool claimed, uint8_t color)
+{
+    if (claimed && color != CHG_LED_SHOW_OFF) {
+        chg_led_apply(color);
     } else {
-        return CONFIG_CHG_BATTERY_COLOR_HIGH;
+        chg_led_off();
     }
 }
 #endif
 #endif
 
-/* Read raw physical level:
- * - 0 = charging (STAT active low, PMIC drives low)
- * - 1 = not charging (open-drain released; internal pull-up keeps high)
+/* Apply LED behavior according to charging state and policy (chg_cfg.policy for the callers). */
+static void apply_state(enum chg_state state, uint8_t policy)
+{
+#ifdef CHG_LED_OUTPUT
+    if (chg_readout_active() || atomic_get(&chg_suspended)) {
+        /* The battery readout drives the LEDs itself and refreshes when done.
+         * Suspended: the pins are released and reclaimed on resume.
+         */
+        return;
+    }
+
+    if (atomic_get(&kbd_dark)) {
+        /* Keyboard asleep/idle: dark until it becomes active again. */
+        led_claim(claims_leds(state), CHG_LED_SHOW_OFF);
+        return;
+    }
+
+    if (atomic_get(&show_battery)) {
+        /* On demand: battery level band color, charging or not. */
+        led_claim(true, get_battery_level_color());
+        return;
+    }
+
+    if (!claims_leds(state)) {
+        /* Not charging (or indicator disabled): keep LEDs OFF and fully delegate to rgbled_widget/others. */
+        led_claim(false, CHG_LED_SHOW_OFF);
+        return;
+    }
+
+    if (policy == CHG_POLICY_OFF || display_is_expired()) {
+        /* Policy off: force LEDs OFF while charging, fully suppress widget output.
+         * Display timed out: hold LEDs OFF until the next transition or user wake.
+         */
+        led_claim(true, CHG_LED_SHOW_OFF);
+        return;
+    }
+
+    switch (state) {
+    case CHG_STATE_COMPLETE:
+        /* Charge complete (tri-state STAT): fixed color, suppress widget output. */
+        led_claim(true, chg_cfg.color_complete);
+        break;
+    case CHG_STATE_FAULT:
+        /* Charger fault (tri-state STAT): fixed color, suppress widget output. */
+        led_claim(true, chg_cfg.color_fault);
+        break;
+    default:
+        if (policy == CHG_POLICY_BATTERY) {
+            /* Charging: show battery level based color, suppress widget output. */
+            led_claim(true, get_battery_level_color());
+        } else {
+            /* Charging: show fixed color, suppress widget output. */
+            led_claim(true, chg_cfg.color);
+        }
+        break;
+    }
+#else
+    ARG_UNUSED(state);
+    ARG_UNUSED(policy);
+    /* No LED channels and no cooperating widget: do nothing (always delegate). */
+#endif
+}
+
+static inline enum chg_state source_state(const struct chg_source *src)
+{
+    const struct chg_stat_driver_api *api = src->dev->api;
+    return api->get_state(src->dev);
+}
+
+/* Combine all source states according to CONFIG_CHG_COMBINE_* (chg_combine_add()):
+ * - ANY: most significant state of any source
+ * - ALL: least significant state (charging only if every source charges)
+ * - PRIORITY: highest-priority source that is not idle decides
+ */
+#if IS_ENABLED(CONFIG_CHG_COMBINE_PRIORITY)
+  #define CHG_COMBINE_POLICY CHG_COMBINE_POLICY_PRIORITY
+#elif IS_ENABLED(CONFIG_CHG_COMBINE_ALL)
+  #define CHG_COMBINE_POLICY CHG_COMBINE_POLICY_ALL
+#else
+  #define CHG_COMBINE_POLICY CHG_COMBINE_POLICY_ANY
+#endif
+
+static enum chg_state combine_sources(void)
+{
+    struct chg_combine c;
+    atomic_val_t faults = 0;
+
+    chg_combine_init(&c);
+    for (size_t i = 0; i < ARRAY_SIZE(chg_sources); i++) {
+        enum chg_state s = source_state(&chg_sources[i]);
+        if (s == CHG_STATE_FAULT && i < 32) {
+            faults |= BIT(i);
+        }
+        chg_combine_add(&c, CHG_COMBINE_POLICY, s, chg_sources[i].priority);
+    }
+    atomic_set(&fault_sources, faults);
+    return c.state;
+}
+
+#if IS_ENABLED(CONFIG_CHG_SESSION)
+/* Session tracking: accumulated in RAM while plugged in, handed to consumers once at the end. */
+static struct chg_session session;
+/* ZMK reports 0 % until its first battery sample, which comes after a session starting at boot:
+ * such a session takes its start level from that sample (and only then starts health tracking).
  */
-static inline bool read_charging(void) {
-    int raw = gpio_pin_get_raw(chg_dev, CHG_PIN_NUM);
-    return raw == 0;
+static bool soc_sampled;
+static bool session_soc_pending;
+
+static void session_update(enum chg_state prev, enum chg_state state, bool warm)
+{
+    if (prev == CHG_STATE_IDLE && state != CHG_STATE_IDLE) {
+        session = (struct chg_session){
+            .start_ms = k_uptime_get_32(),
+            .start_soc = zmk_battery_state_of_charge(),
+            .flags = warm ? CHG_SESSION_F_WARM : 0,
+        };
+        session_soc_pending = !soc_sampled;
+#if IS_ENABLED(CONFIG_CHG_HEALTH)
+        if (!session_soc_pending) {
+            chg_health_session_start(&session);
+        }
+#endif
+    }
+
+    if (state == CHG_STATE_COMPLETE) {
+        session.flags |= CHG_SESSION_F_COMPLETE;
+    } else if (state == CHG_STATE_FAULT) {
+        session.flags |= CHG_SESSION_F_FAULT;
+    }
+
+    if (prev != CHG_STATE_IDLE && state == CHG_STATE_IDLE) {
+        session.end_ms = k_uptime_get_32();
+        session.end_soc = zmk_battery_state_of_charge();
+        if (session_soc_pending) {
+            /* Never sampled during the session: record no change rather than 0 %. */
+            session_soc_pending = false;
+            session.start_soc = session.end_soc;
+        }
+#if IS_ENABLED(CONFIG_CHG_JOURNAL)
+        chg_journal_commit(&session);
+#endif
+#if IS_ENABLED(CONFIG_CHG_HEALTH)
+        chg_health_session_end(&session);
+#endif
+    }
 }
 
-/* Apply LED behavior according to charging state and policy. */
-static void apply_charging_color(bool charging)
+/* Battery sample (same work queue as the evaluation): completes a pending session start. */
+static void session_battery(uint8_t soc)
 {
-#ifndef CHARGE_INDICATOR_DISABLE_LED
-    if (charging) {
-#if IS_ENABLED(CONFIG_CHG_POLICY)
-        /* Charging: force LEDs OFF, fully suppress widget output. */
-        led_red(false); led_green(false); led_blue(false);
+    soc_sampled = true;
+    if (session_soc_pending) {
+        session_soc_pending = false;
+        session.start_soc = soc;
+#if IS_ENABLED(CONFIG_CHG_HEALTH)
+        chg_health_session_start(&session);
+#endif
+    }
+}
 #else
-        /* Charging: show color based on configuration. */
-#if IS_ENABLED(CONFIG_CHG_BATTERY_LEVEL_BASED_COLOR)
-        /* Charging: show battery level based color, suppress widget output. */
-        int color = get_battery_level_color();
-        apply_color_code(color);
+static inline void session_update(enum chg_state prev, enum chg_state state, bool warm) {}
+static inline void session_battery(uint8_t soc) {}
+#endif
+
+#if IS_ENABLED(CONFIG_CHG_WAKE_SOFT_OFF)
+/* Plug-in wake: woken from system off (by a STAT wakeup-source) while charging. Once unplugged,
+ * go straight back to soft off unless the keyboard was used in between.
+ */
+static bool plug_wake;
+static atomic_t user_seen;
+
+/* The reset cause is sticky across resets and shared with the rest of the system, so it is left
+ * alone. Instead, RAM that survives warm resets remembers that this power cycle's cause was
+ * consumed, and a later warm reset does not read as another plug-in wake. Going to soft off
+ * forgets it, in case RAM is retained through system off.
+ */
+#define CHG_WAKE_CONSUMED   0x4357414b /* "CWAK" */
+static __noinit uint32_t wake_cause_consumed;
+
+static inline void plug_wake_rearm(void)
+{
+    wake_cause_consumed = 0;
+}
+
+static void chg_plug_wake_work_handler(struct k_work *work)
+{
+    if (!atomic_get(&user_seen) && atomic_get(&cur_state) == CHG_STATE_IDLE) {
+        LOG_INF("Unplugged after plug-in wake, back to soft off");
+        /* No keyboard SLEEP on this path: arm the wake sources here. */
+        plug_wake_rearm();
+        sources_suspend();
+        if (zmk_pm_soft_off() < 0) {
+            sources_resume();
+        }
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(chg_plug_wake_work, chg_plug_wake_work_handler);
+
+/* Woken from system off (any wake pin) while a source already reports charging. */
+static void plug_wake_check(enum chg_state state)
+{
+    uint32_t cause = 0;
+
+    if (wake_cause_consumed == CHG_WAKE_CONSUMED) {
+        return;
+    }
+    wake_cause_consumed = CHG_WAKE_CONSUMED;
+    if (hwinfo_get_reset_cause(&cause) != 0) {
+        return;
+    }
+    if ((cause & RESET_LOW_POWER_WAKE) && state != CHG_STATE_IDLE) {
+        plug_wake = true;
+        LOG_INF("Plug-in wake from system off");
+    }
+}
+
+static inline void plug_wake_update(enum chg_state state)
+{
+    if (plug_wake && state == CHG_STATE_IDLE) {
+        k_work_reschedule(&chg_plug_wake_work, K_MSEC(CONFIG_CHG_WAKE_LINGER_MS));
+    }
+}
 #else
-        /* Charging: show fixed color, suppress widget output. */
-        apply_color_code(CONFIG_CHG_COLOR);
+static inline void plug_wake_rearm(void) {}
+static inline void plug_wake_check(enum chg_state state) {}
+static inline void plug_wake_update(enum chg_state state) {}
+#endif
+
+#if IS_ENABLED(CONFIG_CHG_WAKE_SOFT_OFF) || CONFIG_CHG_DISPLAY_TIMEOUT_MS > 0
+/* Key presses: the keyboard is in use (no return to soft off), and a timed-out display shows
+ * again. The activity listener only sees the idle -> active edge, which never comes when the
+ * display timeout is shorter than ZMK's idle timeout.
+ */
+static int position_state_changed_listener(const zmk_event_t *eh)
+{
+    const struct zmk_position_state_changed *ev = as_zmk_position_state_changed(eh);
+    if (ev == NULL || !ev->state) {
+        return 0;
+    }
+#if IS_ENABLED(CONFIG_CHG_WAKE_SOFT_OFF)
+    atomic_set(&user_seen, 1);
 #endif
+    if (display_is_expired()) {
+        display_wake();
+        chg_refresh();
+    }
+    return 0;
+}
+
+ZMK_LISTENER(charge_indicator_position, position_state_changed_listener);
+ZMK_SUBSCRIPTION(charge_indicator_position, zmk_position_state_changed);
 #endif
-    } else {
-        /* Not charging: keep LEDs OFF and fully delegate to rgbled_widget/others. */
-        led_red(false); led_green(false); led_blue(false);
+
+#if CHG_TRACE_ENABLED
+/* Trace every source the combine policy outvoted for a new combined state. */
+static void trace_overrides(enum chg_state state)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(chg_sources); i++) {
+        enum chg_state s = source_state(&chg_sources[i]);
+        if (s != state) {
+            CHG_TRACE(CHG_TR_OVERRIDE, i, s);
+        }
     }
+}
 #else
-    ARG_UNUSED(charging);
-    /* No LED aliases: do nothing (always delegate). */
+static inline void trace_overrides(enum chg_state state) {}
 #endif
+
+/* Shared evaluation for all sources: combine -> update state -> apply behavior on change. */
+static void chg_eval_work_handler(struct k_work *work)
+{
+    if (!chg_ready) {
+        return; /* init applies the first combined state */
+    }
+
+    enum chg_state state = combine_sources();
+    enum chg_state prev = atomic_set(&cur_state, state);
+    /* One LED update per confirmed combined transition, none for repeated notifications. */
+    if (prev != state) {
+        CHG_TRACE(CHG_TR_STATE, prev, state);
+        atomic_set(&transition_ms, k_uptime_get_32());
+        trace_overrides(state);
+        display_wake();
+        chg_refresh();
+        chg_retained_save(state);
+        session_update(prev, state, false);
+        plug_wake_update(state);
+#if IS_ENABLED(CONFIG_CHG_READOUT_ON_PLUG)
+        if (prev == CHG_STATE_IDLE) {
+            chg_readout_start();
+        }
+#endif
+    }
+}
+
+static K_WORK_DEFINE(chg_eval_work, chg_eval_work_handler);
+
+/* Warm reboot: re-evaluate once every source confirmed its level, even if none changed. */
+static K_WORK_DELAYABLE_DEFINE(chg_verify_work, chg_eval_work_handler);
+
+void chg_stat_notify(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+    k_work_submit(&chg_eval_work);
+}
+
+static void chg_show_battery_end(struct k_work *work)
+{
+    atomic_clear(&show_battery);
+    chg_refresh();
 }
 
-/* IRQ handler: short debounce -> read raw -> update state -> apply behavior. */
-static void chg_handler(const struct device *port, struct gpio_callback *cb, uint32_t pins)
+static K_WORK_DELAYABLE_DEFINE(chg_show_battery_work, chg_show_battery_end);
+
+void chg_show_battery(void)
 {
-    k_sleep(K_MSEC(8));
-    bool charging = read_charging();
-    atomic_set(&is_charging, charging);
-    apply_charging_color(charging);
+    CHG_TRACE(CHG_TR_SHOW_BATTERY, 0, 0);
+    atomic_set(&show_battery, 1);
+    k_work_reschedule(&chg_show_battery_work, K_MSEC(CONFIG_CHG_SHOW_BATTERY_MS));
+    chg_refresh();
 }
 
 /* Battery state changed event handler: update LED color if charging. */
@@ -177,9 +630,23 @@ static int battery_state_changed_listener(const zmk_event_t *eh)
     if (ev == NULL) {
         return -ENOTSUP;
     }
-
-    if (atomic_get(&is_charging)) {
-        apply_charging_color(true);
+    session_battery(ev->state_of_charge);
+
+    enum chg_state state = atomic_get(&cur_state);
+    if (atomic_get(&show_battery) || (claims_leds(state) && chg_cfg.policy == CHG_POLICY_BATTERY)) {
+#if CONFIG_CHG_DISPLAY_TIMEOUT_MS > 0 && defined(CHG_LED_OUTPUT)
+        /* A band change counts as a transition: show it again for the display timeout. */
+        static int last_band = -1;
+        int band = get_battery_level_color();
+        if (band != last_band) {
+            last_band = band;
+            display_wake();
+        }
+#endif
+        chg_refresh();
+    } else {
+        /* LEDs are the widget's: only the status snapshot follows the battery. */
+        led_post(CHG_LED_OP_STATUS, 0);
     }
 
     return 0;
@@ -188,27 +655,241 @@ static int battery_state_changed_listener(const zmk_event_t *eh)
 ZMK_LISTENER(charge_indicator, battery_state_changed_listener);
 ZMK_SUBSCRIPTION(charge_indicator, zmk_battery_state_changed);
 
-/* Maintenance thread:
- * - While charging: periodically reapply to suppress widget (prevent short blinks).
- * - Not charging: sleep and do nothing (preserve widget timing completely).
+#ifdef CHG_LED_DIRECT
+/* LEDs off and pins released (actor, or the suspend fallback). */
+static void led_release(void)
+{
+    chg_led_off();
+    chg_led_suspend();
+}
+#endif
+
+/* Release the LED pins before system sleep (LEDs off first); the actor applies nothing while
+ * suspended.
+ * - From a thread (keyboard SLEEP): the actor does it and this waits, so a sleep never lands in
+ *   the middle of one of its writes, and the LEDs are off before soft off.
+ * - From the PM notifier (idle thread, interrupts locked; wait is false): idle only runs while
+ *   the actor is blocked between messages, so writing here cannot interleave with it.
+ */
+static void indicator_suspend(bool wait)
+{
+    if (atomic_set(&chg_suspended, 1)) {
+        return;
+    }
+#ifdef CHG_LED_DIRECT
+    if (wait && chg_maint_tid != NULL) {
+        struct chg_led_msg msg = { .op = CHG_LED_OP_SUSPEND };
+
+        k_sem_reset(&chg_suspend_done);
+        if (k_msgq_put(&chg_led_msgq, &msg, CHG_SUSPEND_WAIT) == 0 &&
+            k_sem_take(&chg_suspend_done, CHG_SUSPEND_WAIT) == 0) {
+            return;
+        }
+    }
+    /* No actor yet (or it did not answer): nothing left to wait for before sleeping. */
+    led_release();
+#else
+    ARG_UNUSED(wait);
+#endif
+}
+
+/* Reclaim the LED pins, then let the actor re-apply the current state. */
+static void indicator_resume(void)
+{
+    if (!atomic_get(&chg_suspended)) {
+        return;
+    }
+#ifdef CHG_LED_DIRECT
+    (void)chg_led_init();
+#endif
+    atomic_clear(&chg_suspended);
+    chg_refresh();
+}
+
+/* Keyboard activity:
+ * - SLEEP (or IDLE with CONFIG_CHG_DARK_ON_IDLE): LEDs off (through the actor; synchronously
+ *   before SLEEP), maintenance thread parked. SLEEP also suspends the STAT devices.
+ * - ACTIVE: resume, and show a timed-out indication once more (user wake).
+ */
+static int activity_state_changed_listener(const zmk_event_t *eh)
+{
+    const struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
+    if (ev == NULL) {
+        return -ENOTSUP;
+    }
+    CHG_TRACE(CHG_TR_ACTIVITY, ev->state, 0);
+
+    if (ev->state == ZMK_ACTIVITY_SLEEP ||
+        (IS_ENABLED(CONFIG_CHG_DARK_ON_IDLE) && ev->state == ZMK_ACTIVITY_IDLE)) {
+        if (!atomic_set(&kbd_dark, 1)) {
+            chg_refresh();
+        }
+        if (ev->state == ZMK_ACTIVITY_SLEEP) {
+            /* Soft off follows right away (zmk_pm_soft_off(), no PM notifiers): LEDs off
+             * synchronously, and the STAT devices armed as wake sources before ZMK gets to them.
+             */
+            indicator_suspend(true);
+            plug_wake_rearm();
+            sources_suspend();
+        }
+        return 0;
+    }
+
+    /* Active again (also when soft off failed after SLEEP). */
+    sources_resume();
+    indicator_resume();
+    bool resumed = atomic_clear(&kbd_dark);
+    if (ev->state == ZMK_ACTIVITY_ACTIVE && display_is_expired()) {
+        display_wake();
+        resumed = true;
+    }
+    if (resumed) {
+        chg_refresh();
+    }
+    return 0;
+}
+
+ZMK_LISTENER(charge_indicator_activity, activity_state_changed_listener);
+ZMK_SUBSCRIPTION(charge_indicator_activity, zmk_activity_state_changed);
+
+#if IS_ENABLED(CONFIG_PM)
+/* Only states that lose or stop the system. Runtime idle, suspend-to-idle and standby are
+ * entered from ordinary idle and must leave the indication alone.
+ */
+static inline bool pm_state_deep(enum pm_state state)
+{
+    return state == PM_STATE_SUSPEND_TO_RAM || state == PM_STATE_SUSPEND_TO_DISK ||
+           state == PM_STATE_SOFT_OFF;
+}
+
+/* Deep system PM states: release the LEDs and suspend the STAT devices (level wake
+ * interrupts); restore both on exit.
+ */
+static void chg_pm_state_entry(enum pm_state state)
+{
+    if (!pm_state_deep(state)) {
+        return;
+    }
+    indicator_suspend(false);
+    sources_suspend();
+}
+
+static void chg_pm_state_exit(enum pm_state state)
+{
+    if (!pm_state_deep(state)) {
+        return;
+    }
+    sources_resume();
+    indicator_resume();
+}
+
+static struct pm_notifier chg_pm_notifier = {
+    .state_entry = chg_pm_state_entry,
+    .state_exit = chg_pm_state_exit,
+};
+#endif
+
+#if IS_ENABLED(CONFIG_CHG_STACK_MONITOR)
+/* Stack measurement: rounds of every apply_state() path still to run on the maintenance thread. */
+static atomic_t stress_rounds;
+
+/* Drive all states under all policies (with the band lookup) on this thread. The policy is
+ * passed in, the runtime configuration is left alone; diagnostics only.
+ */
+static void maint_stress(void)
+{
+    while (atomic_get(&stress_rounds) > 0) {
+        for (uint8_t policy = 0; policy < CHG_POLICY_COUNT; policy++) {
+            for (int state = CHG_STATE_IDLE; state <= CHG_STATE_FAULT; state++) {
+                apply_state((enum chg_state)state, policy);
+            }
+        }
+        atomic_dec(&stress_rounds);
+    }
+
+    apply_state(atomic_get(&cur_state), chg_cfg.policy);
+}
+#endif
+
+/* Publish the status snapshot if anything changed since the last one (actor or init only). */
+static void status_update(void)
+{
+    static struct zmk_charge_indicator_status last = { .band = UINT8_MAX };
+    uint8_t soc = zmk_battery_state_of_charge();
+    struct zmk_charge_indicator_status status = {
+        .transition_ms = atomic_get(&transition_ms),
+        .fault_sources = atomic_get(&fault_sources),
+        .state = atomic_get(&cur_state),
+        .band = battery_band(soc),
+        .soc = soc,
+    };
+
+    if (memcmp(&status, &last, sizeof(status)) != 0) {
+        last = status;
+        chg_status_publish(&status);
+    }
+}
+
+/* Readout pulse, dropped once the readout ended (or while suspended). */
+static void led_show(uint8_t color)
+{
+#ifdef CHG_LED_OUTPUT
+    if (!chg_readout_active() || atomic_get(&chg_suspended)) {
+        return;
+    }
+    led_claim(true, color);
+#else
+    ARG_UNUSED(color);
+#endif
+}
+
+/* Maintenance thread / LED actor:
+ * - Handles posted messages: state re-applies (coalesced) and readout pulses.
+ * - While charging (or complete/fault, or showing the battery level): also reapplies every
+ *   150 ms without messages to suppress widget (prevent short blinks). Not needed, and not
+ *   done, with CONFIG_CHG_WIDGET_COOPERATIVE.
+ * - Not charging, disabled, display timed out or readout running: blocks until the next
+ *   message (no periodic wakeups; preserve widget timing completely).
  */
 static void charging_maint_task(void)
 {
+    struct chg_led_msg msg;
+
     while (true) {
-        if (atomic_get(&is_charging)) {
-            apply_charging_color(true);
-            k_sleep(K_MSEC(150)); /* Tune for stronger/weaker suppression vs. power. */
+#if IS_ENABLED(CONFIG_CHG_STACK_MONITOR)
+        if (atomic_get(&stress_rounds) > 0) {
+            maint_stress();
+            continue;
+        }
+#endif
+        /* Tune the period for stronger/weaker suppression vs. power. */
+        k_timeout_t period = display_active(atomic_get(&cur_state)) ? K_MSEC(150) : K_FOREVER;
+
+        if (k_msgq_get(&chg_led_msgq, &msg, period) == 0) {
+            if (msg.op == CHG_LED_OP_SHOW) {
+                led_show(msg.color);
+            } else if (msg.op == CHG_LED_OP_STATUS) {
+                status_update();
+            } else if (msg.op == CHG_LED_OP_SUSPEND) {
+#ifdef CHG_LED_DIRECT
+                led_release();
+#endif
+                k_sem_give(&chg_suspend_done);
+            }
         } else {
-            k_sleep(K_SECONDS(1));
+            atomic_set(&apply_pending, 1);
+        }
+
+        if (atomic_clear(&apply_pending)) {
+            apply_state(atomic_get(&cur_state), chg_cfg.policy);
+            status_update();
         }
     }
 }
 
 /* Initialization:
- * - Resolve DT devices
- * - Configure pins
- * - Stabilization wait + double-read debounce for initial state
- * - IRQ setup
+ * - Configure LED pins
+ * - Combine the initial state of all STAT devices (or use the retained state on warm reboot)
  * - Start maintenance thread
  */
 static int charge_indicator_init(void)
@@ -218,66 +899,106 @@ static int charge_indicator_init(void)
         return 0;
     }
 
-    /* Input (STAT) controller device */
-    chg_dev  = DEVICE_DT_GET(CHG_CTLR);
-    if (!device_is_ready(chg_dev)) {
-        LOG_ERR("CHG GPIO controller not ready");
-        return -ENODEV;
+    int ret = 0;
+#ifdef CHG_LED_DIRECT
+    /* Configure LED output channels (DT table or legacy aliases), unless the widget renders for us. */
+    ret = chg_led_init();
+    if (ret) { return ret; }
+#endif
+
+    /* STAT devices already read their initial state at POST_KERNEL. */
+    for (size_t i = 0; i < ARRAY_SIZE(chg_sources); i++) {
+        if (!device_is_ready(chg_sources[i].dev)) {
+            LOG_ERR("CHG source %s not ready", chg_sources[i].dev->name);
+            return -ENODEV;
+        }
     }
 
-#ifndef CHARGE_INDICATOR_DISABLE_LED
-    /* LED controllers */
-    ledr_dev = DEVICE_DT_GET(LEDR_CTLR);
-    ledg_dev = DEVICE_DT_GET(LEDG_CTLR);
-    ledb_dev = DEVICE_DT_GET(LEDB_CTLR);
-    if (!device_is_ready(ledr_dev) || !device_is_ready(ledg_dev) || !device_is_ready(ledb_dev)) {
-        LOG_ERR("LED GPIO controller not ready");
-        return -ENODEV;
+    /* Warm reboot: show the retained state right away and verify it asynchronously. */
+    enum chg_state state_init;
+    bool warm = chg_retained_get(&state_init);
+    if (!warm) {
+        state_init = combine_sources();
+        chg_retained_save(state_init);
     }
+    atomic_set(&cur_state, state_init);
+    atomic_set(&transition_ms, k_uptime_get_32());
+    display_wake();
+    /* The actor is not running yet: init is the only LED (and status) writer here. */
+    apply_state(state_init, chg_cfg.policy);
+    status_update();
+
+#if IS_ENABLED(CONFIG_CHG_JOURNAL)
+    /* A missing or broken journal only loses history; keep indicating. */
+    (void)chg_journal_init();
 #endif
+    session_update(CHG_STATE_IDLE, state_init, warm);
+    plug_wake_check(state_init);
+    chg_ready = true;
 
-    /* Configure STAT input with pull-up (raw read will be used). */
-    int ret = gpio_pin_configure(chg_dev, CHG_PIN_NUM, CHG_PIN_FLAGS);
-    if (ret) { LOG_ERR("CHG pin cfg failed: %d", ret); return ret; }
+    if (warm) {
+        k_work_schedule(&chg_verify_work, K_MSEC(CHG_STAT_STABILIZE_MS + 10));
+    } else {
+        /* Catch changes confirmed between device init and now. */
+        k_work_submit(&chg_eval_work);
+    }
 
-#ifndef CHARGE_INDICATOR_DISABLE_LED
-    /* Configure RGB output pins. */
-    ret = gpio_pin_configure(ledr_dev, LEDR_PIN, LEDR_FLAGS);
-    if (ret) { LOG_ERR("LEDR cfg failed: %d", ret); return ret; }
-    ret = gpio_pin_configure(ledg_dev, LEDG_PIN, LEDG_FLAGS);
-    if (ret) { LOG_ERR("LEDG cfg failed: %d", ret); return ret; }
-    ret = gpio_pin_configure(ledb_dev, LEDB_PIN, LEDB_FLAGS);
-    if (ret) { LOG_ERR("LEDB cfg failed: %d", ret); return ret; }
+#if IS_ENABLED(CONFIG_PM)
+    pm_notifier_register(&chg_pm_notifier);
 #endif
 
-    /* Initial stabilization + double-read debounce. */
-    k_sleep(K_MSEC(20));
-    bool c1 = read_charging();
-    k_sleep(K_MSEC(10));
-    bool c2 = read_charging();
-    bool charging_init = (c1 && c2);
-    atomic_set(&is_charging, charging_init);
-    apply_charging_color(charging_init);
-
-    /* IRQ on both edges. */
-    ret = gpio_pin_interrupt_configure(chg_dev, CHG_PIN_NUM, GPIO_INT_EDGE_BOTH);
-    if (ret) { LOG_ERR("CHG int cfg failed: %d", ret); return ret; }
-
-    gpio_init_callback(&chg_cb, chg_handler, BIT(CHG_PIN_NUM));
-    ret = gpio_add_callback(chg_dev, &chg_cb);
-    if (ret) { LOG_ERR("CHG add cb failed: %d", ret); return ret; }
-
     /* Start maintenance thread (charging-only suppression). */
-    k_tid_t tid = k_thread_create(&chg_maint_thread,
-                                  chg_maint_stack, K_THREAD_STACK_SIZEOF(chg_maint_stack),
-                                  (k_thread_entry_t)charging_maint_task,
-                                  NULL, NULL, NULL,
-                                  K_LOWEST_THREAD_PRIO, 0, K_NO_WAIT);
-    k_thread_name_set(tid, "chg_maint");
-
-    LOG_INF("Charge indicator init: pin=%d, charging=%d, tid=%p", CHG_PIN_NUM, charging_init, tid);
+    chg_maint_tid = k_thread_create(&chg_maint_thread,
+                                    chg_maint_stack, K_THREAD_STACK_SIZEOF(chg_maint_stack),
+                                    (k_thread_entry_t)charging_maint_task,
+                                    NULL, NULL, NULL,
+                                    K_LOWEST_THREAD_PRIO, 0, K_NO_WAIT);
+    k_thread_name_set(chg_maint_tid, "chg_maint");
+
+    LOG_INF("Charge indicator init: sources=%d, charging=%d, warm=%d, tid=%p",
+            (int)ARRAY_SIZE(chg_sources), state_init, warm, chg_maint_tid);
     return 0;
 }
 
 /* Run after widgets to make suppression predictable. */
 SYS_INIT(charge_indicator_init, APPLICATION, 70);
+
+#if IS_ENABLED(CONFIG_CHG_STACK_MONITOR) && IS_ENABLED(CONFIG_SHELL)
+static int cmd_stack_show(const struct shell *sh, size_t argc, char **argv)
+{
+    size_t unused;
+    int ret = k_thread_stack_space_get(&chg_maint_thread, &unused);
+    if (ret) { shell_error(sh, "stack info failed: %d", ret); return ret; }
+
+    size_t size = K_THREAD_STACK_SIZEOF(chg_maint_stack);
+    shell_print(sh, "chg_maint stack: %u / %u bytes used (high-water mark), %u free",
+                (unsigned)(size - unused), (unsigned)size, (unsigned)unused);
+    return 0;
+}
+
+/* Run the stress rounds on the maintenance thread, wait for them, then report. */
+static int cmd_stack_stress(const struct shell *sh, size_t argc, char **argv)
+{
+    long rounds = argc > 1 ? strtol(argv[1], NULL, 0) : 10;
+    if (rounds <= 0) {
+        shell_error(sh, "rounds must be positive");
+        return -EINVAL;
+    }
+
+    atomic_set(&stress_rounds, rounds);
+    chg_refresh();
+    for (int i = 0; i < 500 && atomic_get(&stress_rounds) > 0; i++) {
+        k_sleep(K_MSEC(10));
+    }
+    if (atomic_get(&stress_rounds) > 0) {
+        shell_warn(sh, "stress still running");
+    }
+    return cmd_stack_show(sh, argc, argv);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(chg_stack_cmds,
+    SHELL_CMD_ARG(stress, NULL, "Drive every LED path on the maintenance thread [rounds]", cmd_stack_stress, 1, 1),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chg), stack, &chg_stack_cmds, "Maintenance thread stack high-water mark", cmd_stack_show, 1, 0);
+#endif
@@ -0,0 +1,217 @@
+// src/charge_indicator.h
+//
+// Internal interfaces shared between the charge indicator sources.
+//
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+
+#include "chg_logic.h"
+
+/* LED channels come from a custom,charge-indicator node, or from the legacy
+ * led-red/green/blue aliases (rgbled_adapter). Without either, LED control is
+ * compiled out and the widget keeps the LEDs.
+ */
+#if DT_HAS_COMPAT_STATUS_OKAY(custom_charge_indicator)
+  #define CHARGE_INDICATOR_DT_LEDS 1
+#elif DT_NODE_HAS_STATUS(DT_ALIAS(led_red), okay) && \
+      DT_NODE_HAS_STATUS(DT_ALIAS(led_green), okay) && \
+      DT_NODE_HAS_STATUS(DT_ALIAS(led_blue), okay)
+  #define CHARGE_INDICATOR_ALIAS_LEDS 1
+#else
+  #define CHARGE_INDICATOR_DISABLE_LED 1
+#endif
+
+/* Number of color codes: the `colors` table of the indicator node, else the eight legacy RGB
+ * codes (also what the widget understands without LED control).
+ */
+#if defined(CHARGE_INDICATOR_DT_LEDS)
+  #define CHG_COLOR_COUNT DT_PROP_LEN(DT_COMPAT_GET_ANY_STATUS_OKAY(custom_charge_indicator), colors)
+#else
+  #define CHG_COLOR_COUNT 8
+#endif
+
+#ifndef CHARGE_INDICATOR_DISABLE_LED
+/* Configure all LED channels as outputs, initially off. */
+int chg_led_init(void);
+
+/* Light the channels of a color code from the color table (out-of-range codes fall back). */
+void chg_led_apply(uint8_t color);
+
+/* Turn every channel off, independent of the color table. */
+void chg_led_off(void);
+
+/* Disconnect all LED pins for system sleep (no leakage through the LEDs).
+ * chg_led_init() reclaims them.
+ */
+void chg_led_suspend(void);
+#endif
+
+/* API implemented by every STAT source driver (custom,chg-stat ...). */
+struct chg_stat_driver_api {
+    /* Last debounced state of this source. */
+    enum chg_state (*get_state)(const struct device *dev);
+};
+
+/* Boot-time stabilization wait of a STAT GPIO (20 ms settle + 10 ms second read). */
+#define CHG_STAT_STABILIZE_MS 30
+
+/* Called by a source once its debounced state changed; schedules one shared
+ * re-evaluation of all sources. Safe from ISR and early init.
+ */
+void chg_stat_notify(const struct device *dev);
+
+#if IS_ENABLED(CONFIG_CHG_RETAINED_STATE)
+/* Last confirmed combined state kept in __noinit RAM across warm reboots.
+ * Returns true (and the state) only if the record survived the reset intact.
+ */
+bool chg_retained_get(enum chg_state *state);
+void chg_retained_save(enum chg_state state);
+#else
+static inline bool chg_retained_get(enum chg_state *state) { ARG_UNUSED(state); return false; }
+static inline void chg_retained_save(enum chg_state state) { ARG_UNUSED(state); }
+#endif
+
+#if IS_ENABLED(CONFIG_CHG_SESSION)
+/* One plug-in period: from leaving CHG_STATE_IDLE until returning to it. */
+struct chg_session {
+    uint32_t start_ms;      /* uptime at start */
+    uint32_t end_ms;        /* uptime at end */
+    uint8_t start_soc;      /* battery % at start */
+    uint8_t end_soc;        /* battery % at end */
+    uint8_t flags;          /* CHG_SESSION_F_* */
+};
+
+#define CHG_SESSION_F_COMPLETE  BIT(0)  /* charger reported complete */
+#define CHG_SESSION_F_FAULT     BIT(1)  /* charger reported a fault */
+#define CHG_SESSION_F_WARM      BIT(2)  /* started from retained state after a warm reboot */
+#endif
+
+#if IS_ENABLED(CONFIG_CHG_JOURNAL)
+/* Mount the journal partition and find the newest record. */
+int chg_journal_init(void);
+
+/* Append one session record (a single flash write). */
+void chg_journal_commit(const struct chg_session *session);
+#endif
+
+#if IS_ENABLED(CONFIG_CHG_HEALTH)
+/* Session hooks for cycle counting and capacity fade estimation. */
+void chg_health_session_start(const struct chg_session *session);
+void chg_health_session_end(const struct chg_session *session);
+#endif
+
+/* Indication policy while charging. */
+enum chg_policy {
+    CHG_POLICY_COLOR = 0,   /* fixed color (color) */
+    CHG_POLICY_BATTERY,     /* battery level band color */
+    CHG_POLICY_OFF,         /* force LEDs off */
+    CHG_POLICY_COUNT,
+};
+
+/* Runtime configuration. Defaults come from Kconfig; with CONFIG_SETTINGS it is loaded from
+ * "chg/cfg" at boot. Hot paths read the fields directly.
+ */
+struct chg_config {
+    uint8_t policy;         /* enum chg_policy */
+    uint8_t color;          /* CONFIG_CHG_COLOR */
+    uint8_t color_complete;
+    uint8_t color_fault;
+    uint8_t level_high;     /* battery % thresholds */
+    uint8_t level_low;
+    uint8_t level_critical;
+    uint8_t band_high;      /* battery band colors */
+    uint8_t band_medium;
+    uint8_t band_low;
+    uint8_t band_critical;
+    uint8_t band_missing;
+    uint8_t enabled;        /* 0: indicator off, LEDs always left to the widget */
+};
+
+extern struct chg_config chg_cfg;
+
+/* Call after changing chg_cfg: refreshes the LEDs once and schedules a debounced save. */
+void chg_config_changed(void);
+
+/* Re-apply the current state to the LEDs through the LED actor (coalesces multiple requests).
+ * Never blocks; safe from any context.
+ */
+void chg_refresh(void);
+
+/* Readout pulse through the LED actor: a color code, or CHG_LED_SHOW_OFF. Ignored unless the
+ * readout is active.
+ */
+#define CHG_LED_SHOW_OFF 0xff
+void chg_led_show(uint8_t color);
+
+/* Publish the public status snapshot (src/status.c). Single writer: the LED actor, or init
+ * before it runs.
+ */
+struct zmk_charge_indicator_status;
+void chg_status_publish(const struct zmk_charge_indicator_status *status);
+
+/* Show the battery level band color for CONFIG_CHG_SHOW_BATTERY_MS, charging or not. */
+void chg_show_battery(void);
+
+#if IS_ENABLED(CONFIG_CHG_READOUT)
+/* Blink the battery % as tens then units pulses. Claims the LEDs until done. */
+void chg_readout_start(void);
+bool chg_readout_active(void);
+#else
+static inline bool chg_readout_active(void) { return false; }
+#endif
+
+#if IS_ENABLED(CONFIG_CHG_EDGE_CAPTURE)
+/* Record one raw STAT edge (ISR) of custom,chg-stat instance src. Paused while a replay runs.
+ * Sources are named by instance index, not pin: two ports can use the same pin number.
+ */
+void chg_edge_capture(uint8_t src, uint8_t level);
+
+/* Replay: force the raw level of custom,chg-stat instance src and run its edge path
+ * (debounce, confirm, combine, LEDs) as if the pin had moved. -ENODEV if there is no such instance.
+ */
+int chg_stat_inject(uint8_t src, uint8_t level);
+
+/* End of replay: every instance reads its pin again (and re-confirms its state). */
+void chg_stat_inject_end(void);
+#endif
+
+/* Hot-path trace events: a binary record (event + small payload) in a static ring instead of
+ * text logging (CONFIG_CHG_TRACE), and/or a Zephyr tracing named event (CONFIG_CHG_TRACING).
+ * Keep in sync with scripts/chg_trace_decode.py.
+ */
+enum chg_trace_event {
+    CHG_TR_LED_APPLY = 1,   /* a: color code (LED writes are traced on change only) */
+    CHG_TR_LED_OFF,
+    CHG_TR_BAND,            /* a: band color, b: battery % (on change only) */
+    CHG_TR_STAT_EDGE,       /* a: chg-stat instance (ISR or replay) */
+    CHG_TR_STAT_CONFIRM,    /* a: chg-stat instance or input code, b: enum chg_state */
+    CHG_TR_STATE,           /* a: previous, b: new combined state */
+    CHG_TR_SHOW_BATTERY,
+    CHG_TR_READOUT,         /* a: battery % */
+    CHG_TR_DISPLAY,         /* a: 1 wake, 0 timeout */
+    CHG_TR_ACTIVITY,        /* a: zmk activity state */
+    CHG_TR_ISR_ENTER,       /* a: chg-stat instance */
+    CHG_TR_ISR_EXIT,        /* a: chg-stat instance */
+    CHG_TR_OVERRIDE,        /* a: source index, b: its state (outvoted by the combine policy) */
+    CHG_TR_COUNT,
+};
+
+#define CHG_TRACE_ENABLED (IS_ENABLED(CONFIG_CHG_TRACE) || IS_ENABLED(CONFIG_CHG_TRACING))
+
+#if CHG_TRACE_ENABLED
+void chg_trace(uint8_t event, uint8_t a, uint16_t b);
+#define CHG_TRACE(event, a, b) chg_trace((event), (a), (b))
+#else
+#define CHG_TRACE(event, a, b) do { } while (0)
+#endif
+
+#if IS_ENABLED(CONFIG_CHG_TRACE)
+/* Empty the trace ring (`chg trace clear`, and a replay start so the ring covers the replay). */
+void chg_trace_clear(void);
+#endif
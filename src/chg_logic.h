@@ -0,0 +1,95 @@
+// src/chg_logic.h
+//
+// Pure debounce and state decisions of the charge indicator.
+// - No kernel, GPIO or devicetree access: inputs are levels, states and timestamps, so the
+//   drivers and the core share one definition and it compiles on the host as well.
+// - The drivers check their runtime behavior against these (see CHG_ASSERT_* in chg_stat.c).
+//
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Charging state of one STAT source, and of the combined indicator.
+ * Ordered by significance: the "any" combine policy reports the highest value.
+ */
+enum chg_state {
+    CHG_STATE_IDLE = 0,     /* not charging */
+    CHG_STATE_COMPLETE,     /* charge complete (tri-state STAT only) */
+    CHG_STATE_CHARGING,
+    CHG_STATE_FAULT,        /* charger fault (tri-state STAT only) */
+};
+
+/* Boot: two reads 10 ms apart must agree, otherwise the line is still moving and the
+ * source starts idle until the debounce confirms the real level.
+ */
+static inline enum chg_state chg_boot_state(enum chg_state s1, enum chg_state s2)
+{
+    return s1 == s2 ? s1 : CHG_STATE_IDLE;
+}
+
+/* Boot reads that disagree need a confirmation of their own: the line may settle before the
+ * edge interrupt is enabled, and then no edge ever schedules the debounce.
+ */
+static inline bool chg_boot_needs_confirm(enum chg_state s1, enum chg_state s2)
+{
+    return s1 != s2;
+}
+
+/* A level may only be confirmed once the line was quiet for the whole debounce window.
+ * Timestamps are 32-bit uptime milliseconds; the subtraction handles wrap-around.
+ */
+static inline bool chg_debounce_settled(uint32_t now_ms, uint32_t last_edge_ms, uint32_t debounce_ms)
+{
+    return (uint32_t)(now_ms - last_edge_ms) >= debounce_ms;
+}
+
+/* Tri-state poll interval: back to min after an edge or change, otherwise doubling up to max. */
+static inline uint32_t chg_poll_next(uint32_t poll_ms, bool activity, uint32_t min_ms, uint32_t max_ms)
+{
+    if (activity) {
+        return min_ms;
+    }
+    return poll_ms * 2 < max_ms ? poll_ms * 2 : max_ms;
+}
+
+/* Combining the sources, one at a time in DT order. */
+enum chg_combine_policy {
+    CHG_COMBINE_POLICY_ANY,         /* most significant state of any source */
+    CHG_COMBINE_POLICY_ALL,         /* least significant state */
+    CHG_COMBINE_POLICY_PRIORITY,    /* highest-priority source that is not idle */
+};
+
+struct chg_combine {
+    enum chg_state state;
+    bool first;
+    int32_t best;           /* priority policy: priority of the deciding source */
+};
+
+static inline void chg_combine_init(struct chg_combine *c)
+{
+    c->state = CHG_STATE_IDLE;
+    c->first = true;
+    c->best = INT32_MIN;
+}
+
+static inline void chg_combine_add(struct chg_combine *c, enum chg_combine_policy policy,
+                                   enum chg_state s, int32_t priority)
+{
+    switch (policy) {
+    case CHG_COMBINE_POLICY_PRIORITY:
+        if (s != CHG_STATE_IDLE && priority > c->best) {
+            c->best = priority;
+            c->state = s;
+        }
+        break;
+    case CHG_COMBINE_POLICY_ALL:
+        c->state = c->first || s < c->state ? s : c->state;
+        break;
+    default:
+        c->state = c->first || s > c->state ? s : c->state;
+        break;
+    }
+    c->first = false;
+}
@@ -0,0 +1,384 @@
+// src/chg_stat.c
+//
+// Charge status (STAT) input driver, one device per custom,chg-stat node.
+// - Reads the raw GPIO level: 0 = charging (PMIC pulls STAT low), 1 = not charging.
+// - Tri-state chargers (low / high / high-Z) are decoded by toggling the pull, only after an edge
+//   and on a slow adaptive poll; binary instances never poll.
+// - Each instance debounces its own edges with a delayable work item (no sleeping in the ISR).
+// - Confirmed changes are reported to the indicator core, which combines all instances.
+// - PM suspend stops the work; wakeup-source instances arm a level interrupt for the opposite level.
+// - Edge capture: raw edges are recorded from the ISR; replay injects levels into the same path.
+//
+
+#define DT_DRV_COMPAT custom_chg_stat
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/pm/device.h>
+
+#include "charge_indicator.h"
+
+LOG_MODULE_DECLARE(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
+
+/* Input flags:
+ * - Use pull-up to keep the line high when PMIC STAT is open-drain (not charging).
+ * - Do NOT set ACTIVE_LOW for input; we read raw level and treat 0 as charging consistently.
+ */
+#define CHG_PIN_FLAGS   (GPIO_INPUT | GPIO_PULL_UP)
+
+/* Physical STAT level, index into chg_stat_config.level_state. */
+enum chg_level {
+    CHG_LEVEL_LOW,
+    CHG_LEVEL_HIGH,
+    CHG_LEVEL_HIZ,
+};
+
+struct chg_stat_config {
+    struct gpio_dt_spec stat;
+    uint8_t src;            /* instance index: names the source in edge capture and replay */
+    uint16_t debounce_ms;
+    bool tri_state;
+    uint8_t level_state[3]; /* enum chg_state per enum chg_level */
+};
+
+struct chg_stat_data {
+    const struct device *dev;
+    struct gpio_callback cb;
+    struct k_work_delayable debounce_work;
+    atomic_t state;
+    atomic_t edge;          /* set by the ISR, consumed by the work item */
+    uint32_t edge_ms;       /* uptime of the last edge */
+    uint32_t poll_ms;       /* tri-state: current adaptive poll interval */
+    bool level_armed;       /* suspended with a level wake interrupt */
+    gpio_flags_t int_flags; /* interrupt mode last configured, restored after a tri-state probe */
+    atomic_t probing;       /* tri-state pull-down probe running: its edges are not line changes */
+#if IS_ENABLED(CONFIG_CHG_EDGE_CAPTURE)
+    int8_t injected;        /* replay: forced raw level, -1 = read the pin */
+#endif
+};
+
+/* Read raw physical level:
+ * - 0 = driven low (STAT active low, PMIC drives low)
+ * - 1 = driven high or released (open-drain released; internal pull-up keeps high)
+ * Tri-state: a high read is repeated with a pull-down; a released line follows the pull.
+ * The pull-down is applied for a few microseconds with the interrupt disabled, then the
+ * interrupt mode in effect before (edges, level wake or none) is restored. An edge the probe
+ * itself latched fires on that restore and is dropped by the handler, so it neither restarts
+ * the debounce nor resets the adaptive poll.
+ */
+static enum chg_level read_level(const struct device *dev)
+{
+    const struct chg_stat_config *cfg = dev->config;
+    struct chg_stat_data *data = dev->data;
+
+#if IS_ENABLED(CONFIG_CHG_EDGE_CAPTURE)
+    if (data->injected >= 0) {
+        return data->injected ? CHG_LEVEL_HIGH : CHG_LEVEL_LOW;
+    }
+#endif
+    if (gpio_pin_get_raw(cfg->stat.port, cfg->stat.pin) == 0) {
+        return CHG_LEVEL_LOW;
+    }
+    if (!cfg->tri_state) {
+        return CHG_LEVEL_HIGH;
+    }
+
+    atomic_set(&data->probing, 1);
+    gpio_pin_interrupt_configure_dt(&cfg->stat, GPIO_INT_DISABLE);
+    gpio_pin_configure(cfg->stat.port, cfg->stat.pin, GPIO_INPUT | GPIO_PULL_DOWN);
+    k_busy_wait(CONFIG_CHG_TRISTATE_SETTLE_US);
+    int down = gpio_pin_get_raw(cfg->stat.port, cfg->stat.pin);
+    gpio_pin_configure(cfg->stat.port, cfg->stat.pin, CHG_PIN_FLAGS);
+    k_busy_wait(CONFIG_CHG_TRISTATE_SETTLE_US);
+    gpio_pin_interrupt_configure_dt(&cfg->stat, data->int_flags);
+    atomic_set(&data->probing, 0);
+
+    return down ? CHG_LEVEL_HIGH : CHG_LEVEL_HIZ;
+}
+
+/* Configure the STAT interrupt and remember the mode for read_level(). */
+static int chg_stat_int_configure(const struct device *dev, gpio_flags_t flags)
+{
+    const struct chg_stat_config *cfg = dev->config;
+    struct chg_stat_data *data = dev->data;
+
+    int ret = gpio_pin_interrupt_configure_dt(&cfg->stat, flags);
+    if (ret == 0) {
+        data->int_flags = flags;
+    }
+    return ret;
+}
+
+static inline enum chg_state read_state(const struct device *dev)
+{
+    const struct chg_stat_config *cfg = dev->config;
+
+    return (enum chg_state)cfg->level_state[read_level(dev)];
+}
+
+/* Runtime invariants (CONFIG_ASSERT), checked against the pure decisions in chg_logic.h:
+ * - a level is never confirmed before the line was quiet for the debounce window;
+ * - it is confirmed within CONFIG_CHG_CONFIRM_LATENCY_MAX_MS after that window.
+ */
+#define CHG_ASSERT_DEBOUNCE(edge_ms, debounce_ms)                                           \
+    do {                                                                                    \
+        uint32_t now_ = k_uptime_get_32();                                                  \
+        __ASSERT(chg_debounce_settled(now_, (edge_ms), (debounce_ms)),                      \
+                 "STAT confirmed %u ms after an edge (debounce %u ms)",                     \
+                 now_ - (edge_ms), (debounce_ms));                                          \
+        __ASSERT(!chg_debounce_settled(now_, (edge_ms),                                     \
+                                       (debounce_ms) + CONFIG_CHG_CONFIRM_LATENCY_MAX_MS + 1), \
+                 "STAT confirm latency %u ms", now_ - (edge_ms));                           \
+        ARG_UNUSED(now_);                                                                   \
+    } while (0)
+
+/* Debounce expired (or tri-state poll due): confirm the current level.
+ * Tri-state lines can move between high and high-Z without an edge, so they are
+ * re-sampled on a poll that starts at CHG_TRISTATE_POLL_MIN_MS after any edge or
+ * change and doubles up to CHG_TRISTATE_POLL_MAX_MS while nothing happens.
+ */
+static void chg_stat_debounce_work(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct chg_stat_data *data = CONTAINER_OF(dwork, struct chg_stat_data, debounce_work);
+    const struct chg_stat_config *cfg = data->dev->config;
+
+    /* Snapshot before consuming the flag. An edge racing with this run re-queues the work,
+     * which then owns the check.
+     */
+    uint32_t edge_ms = data->edge_ms;
+    bool edge = atomic_clear(&data->edge);
+    if (edge && !k_work_delayable_is_pending(dwork)) {
+        CHG_ASSERT_DEBOUNCE(edge_ms, cfg->debounce_ms);
+    }
+
+    enum chg_state state = read_state(data->dev);
+    bool changed = atomic_set(&data->state, state) != state;
+    if (changed) {
+        CHG_TRACE(CHG_TR_STAT_CONFIRM, cfg->src, state);
+        chg_stat_notify(data->dev);
+    }
+
+    if (cfg->tri_state) {
+        data->poll_ms = chg_poll_next(data->poll_ms, edge || changed, CONFIG_CHG_TRISTATE_POLL_MIN_MS,
+                                      CONFIG_CHG_TRISTATE_POLL_MAX_MS);
+        /* No-op if an edge already rescheduled the debounce. */
+        k_work_schedule(&data->debounce_work, K_MSEC(data->poll_ms));
+    }
+}
+
+/* Every edge (real or replayed) restarts this instance's debounce window. */
+static void chg_stat_edge(struct chg_stat_data *data)
+{
+    const struct chg_stat_config *cfg = data->dev->config;
+
+    CHG_TRACE(CHG_TR_STAT_EDGE, cfg->src, 0);
+    data->edge_ms = k_uptime_get_32();
+    atomic_set(&data->edge, 1);
+    k_work_reschedule(&data->debounce_work, K_MSEC(cfg->debounce_ms));
+}
+
+/* IRQ handler. */
+static void chg_stat_handler(const struct device *port, struct gpio_callback *cb, uint32_t pins)
+{
+    struct chg_stat_data *data = CONTAINER_OF(cb, struct chg_stat_data, cb);
+    const struct chg_stat_config *cfg = data->dev->config;
+
+    /* Latched by the tri-state probe while the line stayed high: not a line change. */
+    if (atomic_get(&data->probing) && gpio_pin_get_raw(cfg->stat.port, cfg->stat.pin) != 0) {
+        return;
+    }
+
+    CHG_TRACE(CHG_TR_ISR_ENTER, cfg->src, 0);
+    if (data->level_armed) {
+        /* Woken by the level interrupt: back to edges before it fires again. */
+        data->level_armed = false;
+        chg_stat_int_configure(data->dev, GPIO_INT_EDGE_BOTH);
+    }
+#if IS_ENABLED(CONFIG_CHG_EDGE_CAPTURE)
+    chg_edge_capture(cfg->src, gpio_pin_get_raw(cfg->stat.port, cfg->stat.pin));
+#endif
+    chg_stat_edge(data);
+    CHG_TRACE(CHG_TR_ISR_EXIT, cfg->src, 0);
+}
+
+static enum chg_state chg_stat_get_state(const struct device *dev)
+{
+    struct chg_stat_data *data = dev->data;
+
+    return (enum chg_state)atomic_get(&data->state);
+}
+
+static const struct chg_stat_driver_api chg_stat_api = {
+    .get_state = chg_stat_get_state,
+};
+
+#if IS_ENABLED(CONFIG_PM_DEVICE)
+/* Suspend / turn off: stop debounce and tri-state polling. Enabled wakeup sources arm a level
+ * interrupt for the level opposite to the current one, so plugging in (or out) wakes the system,
+ * also from system off where the controller senses levels (e.g. nRF SENSE). Controllers without
+ * level interrupts keep both edges; other instances (or wakeup disabled at runtime) disable the
+ * interrupt.
+ * Resume goes back to edges and re-reads the line.
+ */
+static int chg_stat_pm_action(const struct device *dev, enum pm_device_action action)
+{
+    const struct chg_stat_config *cfg = dev->config;
+    struct chg_stat_data *data = dev->data;
+    int ret;
+
+    switch (action) {
+    case PM_DEVICE_ACTION_SUSPEND:
+    case PM_DEVICE_ACTION_TURN_OFF:
+        k_work_cancel_delayable(&data->debounce_work);
+        if (!pm_device_wakeup_is_enabled(dev)) {
+            return chg_stat_int_configure(dev, GPIO_INT_DISABLE);
+        }
+        data->level_armed = true;
+        ret = chg_stat_int_configure(dev,
+                  gpio_pin_get_raw(cfg->stat.port, cfg->stat.pin) ? GPIO_INT_LEVEL_LOW
+                                                                 : GPIO_INT_LEVEL_HIGH);
+        if (ret == -ENOTSUP) {
+            data->level_armed = false;
+            ret = 0;
+        }
+        return ret;
+    case PM_DEVICE_ACTION_RESUME:
+        data->level_armed = false;
+        ret = chg_stat_int_configure(dev, GPIO_INT_EDGE_BOTH);
+        if (ret) { LOG_ERR("CHG int cfg failed: %d", ret); return ret; }
+        /* The level may have changed while suspended. */
+        k_work_reschedule(&data->debounce_work, K_MSEC(cfg->debounce_ms));
+        return 0;
+    default:
+        return -ENOTSUP;
+    }
+}
+#endif
+
+/* Initialization:
+ * - Configure STAT input
+ * - Stabilization wait + double-read debounce for initial state (deferred on warm reboot;
+ *   reads that disagree are confirmed by the debounce work)
+ * - IRQ setup (+ first tri-state poll)
+ */
+static int chg_stat_init(const struct device *dev)
+{
+    const struct chg_stat_config *cfg = dev->config;
+    struct chg_stat_data *data = dev->data;
+
+    data->dev = dev;
+    data->int_flags = GPIO_INT_DISABLE;
+#if IS_ENABLED(CONFIG_CHG_EDGE_CAPTURE)
+    data->injected = -1;
+#endif
+    k_work_init_delayable(&data->debounce_work, chg_stat_debounce_work);
+
+    if (!gpio_is_ready_dt(&cfg->stat)) {
+        LOG_ERR("CHG GPIO controller not ready");
+        return -ENODEV;
+    }
+
+    /* Configure STAT input with pull-up (raw read will be used). */
+    int ret = gpio_pin_configure(cfg->stat.port, cfg->stat.pin, CHG_PIN_FLAGS);
+    if (ret) { LOG_ERR("CHG pin cfg failed: %d", ret); return ret; }
+
+    enum chg_state retained;
+    if (chg_retained_get(&retained)) {
+        /* Warm reboot: the indicator starts from the retained state, so take one provisional
+         * read and let the debounce work confirm the level after the stabilization time.
+         */
+        atomic_set(&data->state, read_state(dev));
+        k_work_schedule(&data->debounce_work, K_MSEC(CHG_STAT_STABILIZE_MS));
+    } else {
+        /* Initial stabilization + double-read debounce. */
+        k_sleep(K_MSEC(20));
+        enum chg_state s1 = read_state(dev);
+        k_sleep(K_MSEC(CHG_STAT_STABILIZE_MS - 20));
+        enum chg_state s2 = read_state(dev);
+        atomic_set(&data->state, chg_boot_state(s1, s2));
+        if (chg_boot_needs_confirm(s1, s2)) {
+            k_work_schedule(&data->debounce_work, K_MSEC(cfg->debounce_ms));
+        }
+    }
+
+    /* IRQ on both edges. */
+    ret = chg_stat_int_configure(dev, GPIO_INT_EDGE_BOTH);
+    if (ret) { LOG_ERR("CHG int cfg failed: %d", ret); return ret; }
+
+    gpio_init_callback(&data->cb, chg_stat_handler, BIT(cfg->stat.pin));
+    ret = gpio_add_callback(cfg->stat.port, &data->cb);
+    if (ret) { LOG_ERR("CHG add cb failed: %d", ret); return ret; }
+
+    if (cfg->tri_state) {
+        data->poll_ms = CONFIG_CHG_TRISTATE_POLL_MIN_MS;
+        k_work_schedule(&data->debounce_work, K_MSEC(data->poll_ms));
+    }
+
+#if IS_ENABLED(CONFIG_PM_DEVICE)
+    /* wakeup-source: let the PM subsystem keep this pin as a wake source. */
+    if (pm_device_wakeup_is_capable(dev)) {
+        pm_device_wakeup_enable(dev, true);
+    }
+#endif
+
+    LOG_INF("%s: src=%d, pin=%d, tri-state=%d, state=%d", dev->name, cfg->src, cfg->stat.pin,
+            cfg->tri_state, (int)atomic_get(&data->state));
+    return 0;
+}
+
+#define CHG_STAT_INST(n)                                                            \
+    static const struct chg_stat_config chg_stat_config_##n = {                     \
+        .stat = GPIO_DT_SPEC_INST_GET(n, gpios),                                    \
+        .src = n,                                                                   \
+        .debounce_ms = DT_INST_PROP(n, debounce_ms),                                \
+        .tri_state = DT_INST_PROP(n, tri_state),                                    \
+        .level_state = {                                                            \
+            [CHG_LEVEL_LOW]  = DT_INST_ENUM_IDX(n, low_state),                      \
+            [CHG_LEVEL_HIGH] = DT_INST_ENUM_IDX(n, high_state),                     \
+            [CHG_LEVEL_HIZ]  = DT_INST_ENUM_IDX(n, hiz_state),                      \
+        },                                                                          \
+    };                                                                              \
+    static struct chg_stat_data chg_stat_data_##n;                                  \
+    PM_DEVICE_DT_INST_DEFINE(n, chg_stat_pm_action);                                \
+    DEVICE_DT_INST_DEFINE(n, chg_stat_init, PM_DEVICE_DT_INST_GET(n),               \
+                          &chg_stat_data_##n,                                       \
+                          &chg_stat_config_##n, POST_KERNEL,                        \
+                          CONFIG_CHG_STAT_INIT_PRIORITY, &chg_stat_api);
+
+DT_INST_FOREACH_STATUS_OKAY(CHG_STAT_INST)
+
+#if IS_ENABLED(CONFIG_CHG_EDGE_CAPTURE)
+#define CHG_STAT_DEV(n) DEVICE_DT_INST_GET(n),
+
+static const struct device *const chg_stat_devs[] = {
+    DT_INST_FOREACH_STATUS_OKAY(CHG_STAT_DEV)
+};
+
+int chg_stat_inject(uint8_t src, uint8_t level)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(chg_stat_devs); i++) {
+        const struct chg_stat_config *cfg = chg_stat_devs[i]->config;
+        struct chg_stat_data *data = chg_stat_devs[i]->data;
+
+        if (cfg->src == src) {
+            data->injected = level ? 1 : 0;
+            chg_stat_edge(data);
+            return 0;
+        }
+    }
+    return -ENODEV;
+}
+
+void chg_stat_inject_end(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(chg_stat_devs); i++) {
+        struct chg_stat_data *data = chg_stat_devs[i]->data;
+
+        data->injected = -1;
+        chg_stat_edge(data);
+    }
+}
+#endif
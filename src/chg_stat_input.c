@@ -0,0 +1,97 @@
+// src/chg_stat_input.c
+//
+// Charge status input driver on top of the input subsystem, one device per custom,chg-stat-input node.
+// - The STAT line is a gpio-keys key: gpio-keys owns the interrupt, debounce and PM.
+// - INPUT_EV_KEY events for the key's code update this source and notify the indicator core.
+//
+
+#define DT_DRV_COMPAT custom_chg_stat_input
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/input/input.h>
+#include <zephyr/logging/log.h>
+
+#include "charge_indicator.h"
+
+LOG_MODULE_DECLARE(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
+
+struct chg_stat_input_config {
+    struct gpio_dt_spec key;    /* read once at init; gpio-keys owns the pin */
+    uint16_t code;
+    uint8_t pressed_state;
+    uint8_t released_state;
+};
+
+struct chg_stat_input_data {
+    atomic_t state;
+};
+
+static void chg_stat_input_event(const struct device *dev, struct input_event *evt)
+{
+    const struct chg_stat_input_config *cfg = dev->config;
+    struct chg_stat_input_data *data = dev->data;
+
+    if (evt->type != INPUT_EV_KEY || evt->code != cfg->code) {
+        return;
+    }
+
+    enum chg_state state = evt->value ? cfg->pressed_state : cfg->released_state;
+    if (atomic_set(&data->state, state) != state) {
+        CHG_TRACE(CHG_TR_STAT_CONFIRM, (uint8_t)cfg->code, state);
+        chg_stat_notify(dev);
+    }
+}
+
+static enum chg_state chg_stat_input_get_state(const struct device *dev)
+{
+    struct chg_stat_input_data *data = dev->data;
+
+    return (enum chg_state)atomic_get(&data->state);
+}
+
+static const struct chg_stat_driver_api chg_stat_input_api = {
+    .get_state = chg_stat_input_get_state,
+};
+
+/* Initial state: gpio-keys only reports changes, so read the (already configured) pin once. */
+static int chg_stat_input_init(const struct device *dev)
+{
+    const struct chg_stat_input_config *cfg = dev->config;
+    struct chg_stat_input_data *data = dev->data;
+
+    if (!gpio_is_ready_dt(&cfg->key)) {
+        LOG_ERR("CHG key GPIO controller not ready");
+        return -ENODEV;
+    }
+
+    int active = gpio_pin_get_dt(&cfg->key);
+    if (active < 0) { LOG_ERR("CHG key read failed: %d", active); return active; }
+
+    atomic_set(&data->state, active ? cfg->pressed_state : cfg->released_state);
+    LOG_INF("%s: code=%d, state=%d", dev->name, cfg->code, (int)atomic_get(&data->state));
+    return 0;
+}
+
+#define CHG_KEY_NODE(n) DT_INST_PHANDLE(n, key)
+
+#define CHG_STAT_INPUT_INST(n)                                                      \
+    static const struct chg_stat_input_config chg_stat_input_config_##n = {         \
+        .key = GPIO_DT_SPEC_GET(CHG_KEY_NODE(n), gpios),                            \
+        .code = DT_PROP(CHG_KEY_NODE(n), zephyr_code),                              \
+        .pressed_state = DT_INST_ENUM_IDX(n, pressed_state),                        \
+        .released_state = DT_INST_ENUM_IDX(n, released_state),                      \
+    };                                                                              \
+    static struct chg_stat_input_data chg_stat_input_data_##n;                      \
+    DEVICE_DT_INST_DEFINE(n, chg_stat_input_init, NULL, &chg_stat_input_data_##n,   \
+                          &chg_stat_input_config_##n, POST_KERNEL,                  \
+                          CONFIG_CHG_STAT_INPUT_INIT_PRIORITY, &chg_stat_input_api); \
+    static void chg_stat_input_cb_##n(struct input_event *evt, void *user_data)     \
+    {                                                                               \
+        chg_stat_input_event(DEVICE_DT_INST_GET(n), evt);                           \
+    }                                                                               \
+    INPUT_CALLBACK_DEFINE(DEVICE_DT_GET(DT_PARENT(CHG_KEY_NODE(n))),                \
+                          chg_stat_input_cb_##n, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(CHG_STAT_INPUT_INST)
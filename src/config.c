@@ -0,0 +1,171 @@
+// src/config.c
+//
+// Charge Indicator runtime configuration
+// - One small struct read directly by the hot paths (no settings lookups there).
+// - Kconfig values are the defaults; with CONFIG_SETTINGS the struct is loaded from "chg/cfg"
+//   and saved from a debounced work item, so a burst of changes costs one flash write.
+// - `chg config` shows the values, `chg config set <name> <value>` changes one, `chg config reset`
+//   restores the Kconfig defaults.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include "charge_indicator.h"
+
+LOG_MODULE_DECLARE(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
+
+#if IS_ENABLED(CONFIG_CHG_POLICY)
+  #define CHG_DEFAULT_POLICY CHG_POLICY_OFF
+#elif IS_ENABLED(CONFIG_CHG_BATTERY_LEVEL_BASED_COLOR)
+  #define CHG_DEFAULT_POLICY CHG_POLICY_BATTERY
+#else
+  #define CHG_DEFAULT_POLICY CHG_POLICY_COLOR
+#endif
+
+static const struct chg_config chg_cfg_defaults = {
+    .policy = CHG_DEFAULT_POLICY,
+    .color = CONFIG_CHG_COLOR,
+    .color_complete = CONFIG_CHG_COLOR_COMPLETE,
+    .color_fault = CONFIG_CHG_COLOR_FAULT,
+    .level_high = CONFIG_CHG_BATTERY_LEVEL_HIGH,
+    .level_low = CONFIG_CHG_BATTERY_LEVEL_LOW,
+    .level_critical = CONFIG_CHG_BATTERY_LEVEL_CRITICAL,
+    .band_high = CONFIG_CHG_BATTERY_COLOR_HIGH,
+    .band_medium = CONFIG_CHG_BATTERY_COLOR_MEDIUM,
+    .band_low = CONFIG_CHG_BATTERY_COLOR_LOW,
+    .band_critical = CONFIG_CHG_BATTERY_COLOR_CRITICAL,
+    .band_missing = CONFIG_CHG_BATTERY_COLOR_MISSING,
+    .enabled = 1,
+};
+
+struct chg_config chg_cfg = chg_cfg_defaults;
+
+#if IS_ENABLED(CONFIG_SETTINGS)
+static void chg_config_save_work_handler(struct k_work *work)
+{
+    int ret = settings_save_one("chg/cfg", &chg_cfg, sizeof(chg_cfg));
+    if (ret) {
+        LOG_ERR("Config save failed: %d", ret);
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(chg_config_save_work, chg_config_save_work_handler);
+
+static int chg_config_settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+    if (name && *name) {
+        return -ENOENT;
+    }
+    /* A stored struct of another size is from an incompatible build: keep the defaults. */
+    if (len != sizeof(chg_cfg)) {
+        return 0;
+    }
+
+    struct chg_config stored;
+    if (read_cb(cb_arg, &stored, sizeof(stored)) != sizeof(stored)) {
+        return -EINVAL;
+    }
+    if (stored.policy < CHG_POLICY_COUNT) {
+        chg_cfg = stored;
+    }
+    return 0;
+}
+
+static int chg_config_settings_commit(void)
+{
+    chg_refresh();
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(chg_cfg, "chg/cfg", NULL, chg_config_settings_set,
+                               chg_config_settings_commit, NULL);
+#endif
+
+void chg_config_changed(void)
+{
+    chg_refresh();
+#if IS_ENABLED(CONFIG_SETTINGS)
+    k_work_reschedule(&chg_config_save_work, K_MSEC(CONFIG_CHG_CONFIG_SAVE_DEBOUNCE_MS));
+#endif
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+/* Shell-visible fields: name, offset and upper bound. */
+struct chg_config_field {
+    const char *name;
+    uint8_t offset;
+    uint8_t max;
+};
+
+#define CHG_FIELD(_name, _max) { #_name, offsetof(struct chg_config, _name), _max }
+
+static const struct chg_config_field chg_config_fields[] = {
+    CHG_FIELD(policy, CHG_POLICY_COUNT - 1),
+    CHG_FIELD(color, CHG_COLOR_COUNT - 1),
+    CHG_FIELD(color_complete, CHG_COLOR_COUNT - 1),
+    CHG_FIELD(color_fault, CHG_COLOR_COUNT - 1),
+    CHG_FIELD(level_high, 100),
+    CHG_FIELD(level_low, 100),
+    CHG_FIELD(level_critical, 100),
+    CHG_FIELD(band_high, CHG_COLOR_COUNT - 1),
+    CHG_FIELD(band_medium, CHG_COLOR_COUNT - 1),
+    CHG_FIELD(band_low, CHG_COLOR_COUNT - 1),
+    CHG_FIELD(band_critical, CHG_COLOR_COUNT - 1),
+    CHG_FIELD(band_missing, CHG_COLOR_COUNT - 1),
+    CHG_FIELD(enabled, 1),
+};
+
+static int cmd_config_show(const struct shell *sh, size_t argc, char **argv)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(chg_config_fields); i++) {
+        const struct chg_config_field *f = &chg_config_fields[i];
+        shell_print(sh, "%-15s %u", f->name, ((const uint8_t *)&chg_cfg)[f->offset]);
+    }
+    shell_print(sh, "(policy: 0 color, 1 battery, 2 off)");
+    return 0;
+}
+
+static int cmd_config_set(const struct shell *sh, size_t argc, char **argv)
+{
+    char *end;
+    unsigned long value = strtoul(argv[2], &end, 0);
+
+    for (size_t i = 0; i < ARRAY_SIZE(chg_config_fields); i++) {
+        const struct chg_config_field *f = &chg_config_fields[i];
+        if (strcmp(argv[1], f->name) != 0) {
+            continue;
+        }
+        if (*end != '\0' || value > f->max) {
+            shell_error(sh, "%s: value must be 0..%u", f->name, f->max);
+            return -EINVAL;
+        }
+        ((uint8_t *)&chg_cfg)[f->offset] = value;
+        chg_config_changed();
+        return 0;
+    }
+
+    shell_error(sh, "unknown field: %s", argv[1]);
+    return -EINVAL;
+}
+
+static int cmd_config_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    chg_cfg = chg_cfg_defaults;
+    chg_config_changed();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(chg_config_cmds,
+    SHELL_CMD_ARG(set, NULL, "Set a field: set <name> <value>", cmd_config_set, 3, 0),
+    SHELL_CMD(reset, NULL, "Restore Kconfig defaults", cmd_config_reset),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chg), config, &chg_config_cmds, "Show or change the runtime configuration",
+                 cmd_config_show, 1, 0);
+#endif
@@ -0,0 +1,227 @@
+// src/edges.c
+//
+// Charge Indicator STAT edge capture and replay
+// - Every raw custom,chg-stat edge is recorded from the ISR (cycle timestamp, source, level)
+//   into a static ring; `chg edges raw` dumps it for scripts/chg_edge_replay.py. A source is
+//   the instance index (the `src=` in the boot log), since pins repeat across ports.
+// - Replay feeds a script of edges (loaded from the capture or pushed from the host) back
+//   through the real edge path: injected levels, the instance's debounce work, the combine
+//   and the LEDs. Idle gaps longer than the settle time are shortened, so a replay runs faster
+//   than real time without changing what gets confirmed. A run clears the trace ring first, so
+//   `chg trace raw` afterwards holds the replay's state and LED events.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include "charge_indicator.h"
+
+LOG_MODULE_DECLARE(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_CHG_EDGE_CAPTURE_RECORDS),
+             "CONFIG_CHG_EDGE_CAPTURE_RECORDS must be a power of two");
+
+/* Keep in sync with scripts/chg_edge_replay.py. */
+struct chg_edge_record {
+    uint32_t cycles;        /* k_cycle_get_32() at the edge */
+    uint8_t src;            /* custom,chg-stat instance index */
+    uint8_t level;          /* raw level read in the ISR */
+    uint16_t seq;           /* capture sequence number (low bits), spots overwritten records */
+} __packed;
+
+BUILD_ASSERT(sizeof(struct chg_edge_record) == 8, "edge record layout changed");
+
+static struct chg_edge_record chg_edges[CONFIG_CHG_EDGE_CAPTURE_RECORDS];
+static atomic_t chg_edges_head;
+
+/* Replay script: one step per edge, delay relative to the previous step. */
+struct chg_replay_step {
+    uint32_t delay_ms;
+    uint8_t src;
+    uint8_t level;
+};
+
+static struct chg_replay_step chg_replay[CONFIG_CHG_EDGE_CAPTURE_RECORDS];
+static size_t chg_replay_len, chg_replay_pos;
+static uint32_t chg_replay_max_gap_ms;
+static atomic_t chg_replaying;
+
+void chg_edge_capture(uint8_t src, uint8_t level)
+{
+    if (atomic_get(&chg_replaying)) {
+        return;
+    }
+
+    uint32_t seq = (uint32_t)atomic_inc(&chg_edges_head);
+    struct chg_edge_record *rec = &chg_edges[seq & (CONFIG_CHG_EDGE_CAPTURE_RECORDS - 1)];
+
+    rec->cycles = k_cycle_get_32();
+    rec->src = src;
+    rec->level = level;
+    rec->seq = (uint16_t)seq;
+}
+
+static void chg_replay_step_work(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(chg_replay_work, chg_replay_step_work);
+
+static void chg_replay_step_work(struct k_work *work)
+{
+    if (chg_replay_pos >= chg_replay_len) {
+        /* The last edge has settled: hand the pins back. */
+        chg_stat_inject_end();
+        atomic_clear(&chg_replaying);
+        LOG_INF("Replay done: %u edges", (unsigned)chg_replay_len);
+        return;
+    }
+
+    const struct chg_replay_step *step = &chg_replay[chg_replay_pos++];
+    if (chg_stat_inject(step->src, step->level)) {
+        LOG_ERR("Replay: no custom,chg-stat instance %u", step->src);
+    }
+
+    uint32_t next = chg_replay_pos < chg_replay_len ? chg_replay[chg_replay_pos].delay_ms
+                                                    : chg_replay_max_gap_ms;
+    k_work_schedule(&chg_replay_work, K_MSEC(MIN(next, chg_replay_max_gap_ms)));
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+static int cmd_edges_dump(const struct shell *sh, bool raw)
+{
+    uint32_t head = atomic_get(&chg_edges_head);
+    uint32_t count = MIN(head, CONFIG_CHG_EDGE_CAPTURE_RECORDS);
+    uint32_t hz = sys_clock_hw_cycles_per_sec();
+
+    if (raw) {
+        shell_print(sh, "hz %u", hz);
+    }
+    for (uint32_t i = head - count; i != head; i++) {
+        struct chg_edge_record rec = chg_edges[i & (CONFIG_CHG_EDGE_CAPTURE_RECORDS - 1)];
+        if (raw) {
+            shell_hexdump_line(sh, 0, (const uint8_t *)&rec, sizeof(rec));
+        } else {
+            shell_print(sh, "#%u %10u us  src %u -> %u", rec.seq,
+                        (uint32_t)((uint64_t)rec.cycles * USEC_PER_SEC / hz), rec.src, rec.level);
+        }
+    }
+    return 0;
+}
+
+static int cmd_edges_list(const struct shell *sh, size_t argc, char **argv)
+{
+    return cmd_edges_dump(sh, false);
+}
+
+static int cmd_edges_raw(const struct shell *sh, size_t argc, char **argv)
+{
+    return cmd_edges_dump(sh, true);
+}
+
+static int cmd_edges_clear(const struct shell *sh, size_t argc, char **argv)
+{
+    memset(chg_edges, 0, sizeof(chg_edges));
+    atomic_clear(&chg_edges_head);
+    chg_replay_len = 0;
+    return 0;
+}
+
+static int replay_busy(const struct shell *sh)
+{
+    if (atomic_get(&chg_replaying)) {
+        shell_error(sh, "replay running");
+        return -EBUSY;
+    }
+    return 0;
+}
+
+/* Copy the capture into the replay script. */
+static int cmd_edges_load(const struct shell *sh, size_t argc, char **argv)
+{
+    int ret = replay_busy(sh);
+    if (ret) { return ret; }
+
+    uint32_t head = atomic_get(&chg_edges_head);
+    uint32_t count = MIN(head, CONFIG_CHG_EDGE_CAPTURE_RECORDS);
+    uint32_t prev = 0;
+
+    chg_replay_len = 0;
+    for (uint32_t i = head - count; i != head; i++) {
+        const struct chg_edge_record *rec = &chg_edges[i & (CONFIG_CHG_EDGE_CAPTURE_RECORDS - 1)];
+        uint32_t delta = chg_replay_len ? rec->cycles - prev : 0;
+        chg_replay[chg_replay_len++] = (struct chg_replay_step){
+            .delay_ms = k_cyc_to_ms_floor32(delta),
+            .src = rec->src,
+            .level = rec->level,
+        };
+        prev = rec->cycles;
+    }
+    shell_print(sh, "%u edges loaded", (unsigned)chg_replay_len);
+    return 0;
+}
+
+/* push <src> <level> <delay_ms>: append one step (host-fed field traces). */
+static int cmd_edges_push(const struct shell *sh, size_t argc, char **argv)
+{
+    int ret = replay_busy(sh);
+    if (ret) { return ret; }
+
+    if (chg_replay_len >= ARRAY_SIZE(chg_replay)) {
+        shell_error(sh, "replay script full");
+        return -ENOMEM;
+    }
+    chg_replay[chg_replay_len++] = (struct chg_replay_step){
+        .src = strtoul(argv[1], NULL, 0),
+        .level = strtoul(argv[2], NULL, 0) ? 1 : 0,
+        .delay_ms = strtoul(argv[3], NULL, 0),
+    };
+    return 0;
+}
+
+static int cmd_edges_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    int ret = replay_busy(sh);
+    if (ret) { return ret; }
+
+    chg_replay_len = 0;
+    return 0;
+}
+
+/* run [max_gap_ms]: replay the script; gaps are capped (default 1000 ms), which must stay
+ * above the debounce time so the same levels get confirmed.
+ */
+static int cmd_edges_run(const struct shell *sh, size_t argc, char **argv)
+{
+    if (chg_replay_len == 0) {
+        shell_error(sh, "replay script empty (load or push)");
+        return -ENOENT;
+    }
+    if (atomic_set(&chg_replaying, 1)) {
+        shell_error(sh, "replay running");
+        return -EBUSY;
+    }
+
+    chg_replay_max_gap_ms = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000;
+    chg_replay_pos = 0;
+#if IS_ENABLED(CONFIG_CHG_TRACE)
+    chg_trace_clear();
+#endif
+    k_work_reschedule(&chg_replay_work, K_NO_WAIT);
+    shell_print(sh, "replaying %u edges", (unsigned)chg_replay_len);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(chg_edges_cmds,
+    SHELL_CMD(list, NULL, "List captured STAT edges", cmd_edges_list),
+    SHELL_CMD(raw, NULL, "Dump captured edges as hex (scripts/chg_edge_replay.py)", cmd_edges_raw),
+    SHELL_CMD(clear, NULL, "Clear the capture and the replay script", cmd_edges_clear),
+    SHELL_CMD(load, NULL, "Load the capture as replay script", cmd_edges_load),
+    SHELL_CMD_ARG(push, NULL, "Append a replay step: <src> <level> <delay_ms>", cmd_edges_push, 4, 0),
+    SHELL_CMD(reset, NULL, "Empty the replay script", cmd_edges_reset),
+    SHELL_CMD_ARG(run, NULL, "Replay the script [max_gap_ms]", cmd_edges_run, 1, 1),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chg), edges, &chg_edges_cmds, "STAT edge capture and replay", cmd_edges_list, 1, 0);
+#endif
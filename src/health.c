@@ -0,0 +1,149 @@
+// src/health.c
+//
+// Charge Indicator battery health estimator
+// - Cycle counter: every battery % gained while plugged in is accumulated; 100 % = one cycle.
+//   Gains count above the session's running maximum, so ADC jitter (80 -> 79 -> 80) adds nothing.
+// - Capacity fade: with a constant charge current, a faded cell needs fewer seconds per %.
+//   The charge time per % in the constant-current range (below CHG_HEALTH_SOC_MAX) is averaged
+//   over the first sessions as a reference and then tracked with a slow moving average.
+// - State is a few bytes under the settings key "chg/health", saved at most once per session.
+//
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/battery_state_changed.h>
+
+#include "charge_indicator.h"
+
+LOG_MODULE_DECLARE(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
+
+#define CHG_HEALTH_VERSION 1
+
+/* Persisted state (10 bytes). */
+struct chg_health_state {
+    uint32_t charged_pct;   /* total % gained while charging; / 100 = cycles */
+    uint16_t ref_ds_per_pct;/* reference charge time per % (0.1 s) */
+    uint16_t avg_ds_per_pct;/* moving average charge time per % (0.1 s) */
+    uint8_t ref_sessions;   /* sessions in the reference (up to CHG_HEALTH_REF_SESSIONS) */
+    uint8_t version;
+} __packed;
+
+static struct chg_health_state health = { .version = CHG_HEALTH_VERSION };
+
+/* Current session, RAM only. */
+static bool session_active;
+static bool dirty;              /* state changed since the last save */
+static uint8_t max_soc;         /* highest sample this session, for cycle accumulation */
+static uint32_t cc_start_ms;    /* first sample of the constant-current window */
+static uint8_t cc_start_soc;
+static uint32_t cc_last_ms;     /* last sample still inside the window */
+static uint8_t cc_last_soc;
+
+void chg_health_session_start(const struct chg_session *session)
+{
+    session_active = true;
+    max_soc = session->start_soc;
+    /* Now, not session->start_ms: the start level may come from a sample taken after plug-in. */
+    cc_start_ms = cc_last_ms = k_uptime_get_32();
+    cc_start_soc = cc_last_soc = session->start_soc;
+}
+
+static int chg_health_battery_listener(const zmk_event_t *eh)
+{
+    const struct zmk_battery_state_changed *ev = as_zmk_battery_state_changed(eh);
+    if (ev == NULL || !session_active) {
+        return 0;
+    }
+
+    uint8_t soc = ev->state_of_charge;
+    if (soc > max_soc && soc <= 100) {
+        health.charged_pct += soc - max_soc;
+        max_soc = soc;
+        dirty = true;
+    }
+
+    if (soc <= CONFIG_CHG_HEALTH_SOC_MAX && soc > cc_last_soc) {
+        cc_last_ms = k_uptime_get_32();
+        cc_last_soc = soc;
+    }
+    return 0;
+}
+
+ZMK_LISTENER(chg_health, chg_health_battery_listener);
+ZMK_SUBSCRIPTION(chg_health, zmk_battery_state_changed);
+
+void chg_health_session_end(const struct chg_session *session)
+{
+    if (!session_active) {
+        return;
+    }
+    session_active = false;
+
+    /* Only sessions that charged long enough in the constant-current range tell us anything. */
+    uint8_t delta = cc_last_soc - cc_start_soc;
+    if (delta >= CONFIG_CHG_HEALTH_MIN_DELTA && !(session->flags & CHG_SESSION_F_FAULT)) {
+        uint32_t ds_per_pct = (cc_last_ms - cc_start_ms) / 100 / delta;
+        ds_per_pct = MIN(ds_per_pct, UINT16_MAX);
+
+        if (health.ref_sessions < CONFIG_CHG_HEALTH_REF_SESSIONS) {
+            /* Reference: running mean of the first sessions. */
+            health.ref_sessions++;
+            health.ref_ds_per_pct += ((int32_t)ds_per_pct - health.ref_ds_per_pct) / health.ref_sessions;
+            health.avg_ds_per_pct = health.ref_ds_per_pct;
+        } else {
+            /* Slow exponential moving average (1/8 per session). */
+            health.avg_ds_per_pct += ((int32_t)ds_per_pct - health.avg_ds_per_pct) / 8;
+        }
+        dirty = true;
+    }
+
+    /* At most one write per session, and only if something was learned. */
+    if (dirty) {
+        dirty = false;
+        int ret = settings_save_one("chg/health", &health, sizeof(health));
+        if (ret) {
+            LOG_ERR("Health save failed: %d", ret);
+        }
+    }
+}
+
+static int chg_health_settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+    struct chg_health_state stored;
+
+    if (name && *name) {
+        return -ENOENT;
+    }
+    if (len != sizeof(stored) || read_cb(cb_arg, &stored, sizeof(stored)) != sizeof(stored)) {
+        return -EINVAL;
+    }
+    if (stored.version == CHG_HEALTH_VERSION) {
+        health = stored;
+    }
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(chg_health, "chg/health", NULL, chg_health_settings_set, NULL, NULL);
+
+#if IS_ENABLED(CONFIG_SHELL)
+static int cmd_health(const struct shell *sh, size_t argc, char **argv)
+{
+    shell_print(sh, "cycles: %u.%02u", health.charged_pct / 100, health.charged_pct % 100);
+    if (health.ref_sessions == 0 || health.ref_ds_per_pct == 0) {
+        shell_print(sh, "capacity: not enough sessions yet");
+        return 0;
+    }
+    shell_print(sh, "charge time per %%: %u.%u s (reference %u.%u s over %u sessions)",
+                health.avg_ds_per_pct / 10, health.avg_ds_per_pct % 10,
+                health.ref_ds_per_pct / 10, health.ref_ds_per_pct % 10, health.ref_sessions);
+    shell_print(sh, "estimated capacity: %u%%",
+                MIN(100U, (uint32_t)health.avg_ds_per_pct * 100 / health.ref_ds_per_pct));
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((chg), health, NULL, "Battery cycles and capacity estimate", cmd_health, 1, 0);
+#endif
@@ -0,0 +1,182 @@
+// src/journal.c
+//
+// Charge Indicator session journal
+// - One 16-byte record per charge session, kept in a fixed-size ring of NVS entries on the
+//   chg_journal_partition flash partition (NVS provides the wear leveling).
+// - Sessions are accumulated in RAM by the core and committed once at session end: one flash
+//   write per session, no header entry (the newest record is found by scanning at mount).
+// - `chg journal` streams records one at a time through a stack buffer; `chg journal raw`
+//   prints them as hex for scripts/chg_journal_decode.py.
+//
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/fs/nvs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/util.h>
+
+#include "charge_indicator.h"
+
+LOG_MODULE_DECLARE(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
+
+#define CHG_JOURNAL_VERSION 1
+
+/* On-flash record, little-endian. Keep in sync with scripts/chg_journal_decode.py. */
+struct chg_journal_record {
+    uint16_t seq;           /* record sequence number, starts at 1 */
+    uint16_t boot;          /* boot epoch: uptimes of records with the same epoch are comparable */
+    uint32_t start_s;       /* uptime at session start (s) */
+    uint32_t duration_s;    /* session length (s) */
+    uint8_t start_soc;      /* battery % at start */
+    uint8_t end_soc;        /* battery % at end */
+    uint8_t flags;          /* CHG_SESSION_F_* */
+    uint8_t version;        /* CHG_JOURNAL_VERSION */
+} __packed;
+
+BUILD_ASSERT(sizeof(struct chg_journal_record) == 16, "journal record layout changed");
+
+/* NVS ids 1..CONFIG_CHG_JOURNAL_RECORDS hold the ring; id 0 is unused. */
+#define CHG_JOURNAL_ID(seq) (1 + ((seq) % CONFIG_CHG_JOURNAL_RECORDS))
+
+static struct nvs_fs chg_journal_fs = {
+    .flash_device = FIXED_PARTITION_DEVICE(chg_journal_partition),
+    .offset = FIXED_PARTITION_OFFSET(chg_journal_partition),
+};
+
+static bool chg_journal_ready;
+static uint16_t chg_journal_next_seq = 1;
+static uint16_t chg_journal_boot;
+
+static int chg_journal_read(uint16_t seq, struct chg_journal_record *rec)
+{
+    ssize_t len = nvs_read(&chg_journal_fs, CHG_JOURNAL_ID(seq), rec, sizeof(*rec));
+    if (len != sizeof(*rec) || rec->seq != seq) {
+        return -ENOENT;
+    }
+    return 0;
+}
+
+int chg_journal_init(void)
+{
+    struct flash_pages_info info;
+
+    if (!device_is_ready(chg_journal_fs.flash_device)) {
+        LOG_ERR("Journal flash not ready");
+        return -ENODEV;
+    }
+
+    int ret = flash_get_page_info_by_offs(chg_journal_fs.flash_device, chg_journal_fs.offset, &info);
+    if (ret) { LOG_ERR("Journal page info failed: %d", ret); return ret; }
+
+    chg_journal_fs.sector_size = info.size;
+    chg_journal_fs.sector_count = FIXED_PARTITION_SIZE(chg_journal_partition) / info.size;
+    ret = nvs_mount(&chg_journal_fs);
+    if (ret) { LOG_ERR("Journal mount failed: %d", ret); return ret; }
+
+    /* Newest record = highest seq in the ring; its epoch + 1 is this boot's epoch. */
+    struct chg_journal_record rec, newest = {0};
+    for (uint16_t id = 1; id <= CONFIG_CHG_JOURNAL_RECORDS; id++) {
+        if (nvs_read(&chg_journal_fs, id, &rec, sizeof(rec)) == sizeof(rec) && rec.seq > newest.seq) {
+            newest = rec;
+        }
+    }
+    chg_journal_next_seq = newest.seq + 1;
+    chg_journal_boot = newest.seq ? newest.boot + 1 : 0;
+    chg_journal_ready = true;
+
+    LOG_INF("Journal: next seq %u, boot epoch %u", chg_journal_next_seq, chg_journal_boot);
+    return 0;
+}
+
+void chg_journal_commit(const struct chg_session *session)
+{
+    if (!chg_journal_ready) {
+        return;
+    }
+
+    struct chg_journal_record rec = {
+        .seq = chg_journal_next_seq,
+        .boot = chg_journal_boot,
+        .start_s = session->start_ms / MSEC_PER_SEC,
+        .duration_s = (session->end_ms - session->start_ms) / MSEC_PER_SEC,
+        .start_soc = session->start_soc,
+        .end_soc = session->end_soc,
+        .flags = session->flags,
+        .version = CHG_JOURNAL_VERSION,
+    };
+
+    ssize_t ret = nvs_write(&chg_journal_fs, CHG_JOURNAL_ID(rec.seq), &rec, sizeof(rec));
+    if (ret < 0) {
+        LOG_ERR("Journal write failed: %d", (int)ret);
+        return;
+    }
+    /* 65535 sessions is beyond the life of the keyboard; stop rather than wrap. */
+    if (chg_journal_next_seq < UINT16_MAX) {
+        chg_journal_next_seq++;
+    }
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+/* Stream records oldest first, one stack buffer at a time. */
+static int chg_journal_dump(const struct shell *sh, bool raw)
+{
+    if (!chg_journal_ready) {
+        shell_error(sh, "journal not mounted");
+        return -ENODEV;
+    }
+
+    uint16_t last = chg_journal_next_seq - 1;
+    uint16_t first = last > CONFIG_CHG_JOURNAL_RECORDS ? last - CONFIG_CHG_JOURNAL_RECORDS + 1 : 1;
+    struct chg_journal_record rec;
+
+    for (uint32_t seq = first; seq <= last; seq++) {
+        if (chg_journal_read(seq, &rec)) {
+            continue;
+        }
+        if (raw) {
+            shell_hexdump_line(sh, 0, (const uint8_t *)&rec, sizeof(rec));
+        } else {
+            shell_print(sh, "#%u boot %u start %us dur %us soc %u%%->%u%% flags 0x%02x",
+                        rec.seq, rec.boot, rec.start_s, rec.duration_s,
+                        rec.start_soc, rec.end_soc, rec.flags);
+        }
+    }
+    return 0;
+}
+
+static int cmd_journal_list(const struct shell *sh, size_t argc, char **argv)
+{
+    return chg_journal_dump(sh, false);
+}
+
+static int cmd_journal_raw(const struct shell *sh, size_t argc, char **argv)
+{
+    return chg_journal_dump(sh, true);
+}
+
+static int cmd_journal_clear(const struct shell *sh, size_t argc, char **argv)
+{
+    if (!chg_journal_ready) {
+        shell_error(sh, "journal not mounted");
+        return -ENODEV;
+    }
+
+    chg_journal_ready = false;
+    int ret = nvs_clear(&chg_journal_fs);
+    if (ret == 0) {
+        ret = chg_journal_init();
+    }
+    return ret;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(chg_journal_cmds,
+    SHELL_CMD(list, NULL, "List session records", cmd_journal_list),
+    SHELL_CMD(raw, NULL, "Dump records as hex (scripts/chg_journal_decode.py)", cmd_journal_raw),
+    SHELL_CMD(clear, NULL, "Erase the journal", cmd_journal_clear),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chg), journal, &chg_journal_cmds, "Charge session journal", cmd_journal_list, 1, 0);
+#endif
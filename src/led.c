@@ -0,0 +1,213 @@
+// src/led.c
+//
+// Charge Indicator LED driver
+// - Channels and color table come from a custom,charge-indicator node (or the legacy RGB aliases).
+// - Everything is expanded at build time into const per-port tables: one masked raw write per
+//   GPIO port per color, no per-pin switch and no runtime table construction.
+// - Channels spread over several ports change off-before-on (see chg_led_write()), so switching
+//   colors never flashes a third hue in between.
+//
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include "charge_indicator.h"
+
+LOG_MODULE_DECLARE(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
+
+#ifndef CHARGE_INDICATOR_DISABLE_LED
+
+/* Channel and color table sources. Each provides:
+ * - CHG_LED_COUNT       number of channels
+ * - CHG_LED_NODE(i)     gpio-leds child node of channel i
+ * - CHG_LED_EXISTS(i)   literal 1/0 whether channel i exists (i < 8)
+ * - CHG_COLOR_MASK(c)   channel bitmask of color code c
+ * - CHG_COLOR_CODES     comma separated list 0 .. CHG_COLOR_COUNT-1
+ * CHG_COLOR_COUNT itself is in charge_indicator.h (the config shell bounds codes by it).
+ */
+#if defined(CHARGE_INDICATOR_DT_LEDS)
+  #define IND_NODE            DT_COMPAT_GET_ANY_STATUS_OKAY(custom_charge_indicator)
+  #define CHG_LED_COUNT       DT_PROP_LEN(IND_NODE, leds)
+  #define CHG_LED_NODE(i)     DT_PHANDLE_BY_IDX(IND_NODE, leds, i)
+  #define CHG_LED_EXISTS(i)   DT_PROP_HAS_IDX(IND_NODE, leds, i)
+  #define CHG_COLOR_MASK(c)   DT_PROP_BY_IDX(IND_NODE, colors, c)
+  #define CHG_COLOR_IDX(node_id, prop, idx) idx
+  #define CHG_COLOR_CODES     DT_FOREACH_PROP_ELEM_SEP(IND_NODE, colors, CHG_COLOR_IDX, (,))
+#else
+  /* Legacy aliases: channels red, green, blue; color code == channel bitmask. */
+  #define CHG_LED_COUNT       3
+  #define CHG_LED_NODE(i)     UTIL_CAT(CHG_ALIAS_LED_, i)
+  #define CHG_ALIAS_LED_0     DT_ALIAS(led_red)
+  #define CHG_ALIAS_LED_1     DT_ALIAS(led_green)
+  #define CHG_ALIAS_LED_2     DT_ALIAS(led_blue)
+  #define CHG_LED_EXISTS(i)   UTIL_CAT(CHG_ALIAS_LED_EXISTS_, i)
+  #define CHG_ALIAS_LED_EXISTS_0 1
+  #define CHG_ALIAS_LED_EXISTS_1 1
+  #define CHG_ALIAS_LED_EXISTS_2 1
+  #define CHG_ALIAS_LED_EXISTS_3 0
+  #define CHG_ALIAS_LED_EXISTS_4 0
+  #define CHG_ALIAS_LED_EXISTS_5 0
+  #define CHG_ALIAS_LED_EXISTS_6 0
+  #define CHG_ALIAS_LED_EXISTS_7 0
+  #define CHG_COLOR_MASK(c)   (c)
+  #define CHG_COLOR_CODES     0, 1, 2, 3, 4, 5, 6, 7
+#endif
+
+BUILD_ASSERT(CHG_LED_COUNT >= 1 && CHG_LED_COUNT <= 8, "charge indicator supports 1..8 LED channels");
+BUILD_ASSERT(CHG_COLOR_COUNT >= 1, "charge indicator color table is empty");
+BUILD_ASSERT(CHG_COLOR_COUNT < CHG_LED_SHOW_OFF, "charge indicator color table too large");
+
+/* Fallback for codes past the end of the table (legacy behavior: red). */
+#define CHG_COLOR_FALLBACK  (CHG_COLOR_COUNT > 1 ? 1 : 0)
+
+#define CHG_LED_CTLR(i)         DT_GPIO_CTLR(CHG_LED_NODE(i), gpios)
+#define CHG_LED_PIN(i)          DT_GPIO_PIN(CHG_LED_NODE(i), gpios)
+#define CHG_LED_ACTIVE_LOW(i)   ((DT_GPIO_FLAGS(CHG_LED_NODE(i), gpios) & GPIO_ACTIVE_LOW) ? 1 : 0)
+#define CHG_LED_SAME_PORT(i, j) DT_SAME_NODE(CHG_LED_CTLR(i), CHG_LED_CTLR(j))
+
+/* Per-channel terms over every channel j sharing channel i's port.
+ * Unrolled by hand (max 8 channels) so it can nest inside LISTIFY/FOR_EACH.
+ */
+#define CHG_EACH_CHANNEL(F, i, c) \
+    (F(0, i, c) | F(1, i, c) | F(2, i, c) | F(3, i, c) | \
+     F(4, i, c) | F(5, i, c) | F(6, i, c) | F(7, i, c))
+
+#define CHG_PORT_PIN_IF(j, i, cond) \
+    COND_CODE_1(CHG_LED_EXISTS(j), \
+                ((CHG_LED_SAME_PORT(i, j) && (cond)) ? BIT(CHG_LED_PIN(j)) : 0), (0))
+
+/* Channel j lit in color c -> raw level is the inverse of its active-low flag. */
+#define CHG_LIT(j, c)           ((((CHG_COLOR_MASK(c)) >> (j)) & 1) != CHG_LED_ACTIVE_LOW(j))
+#define CHG_MASK_BIT(j, i, c)   CHG_PORT_PIN_IF(j, i, 1)
+#define CHG_OFF_BIT(j, i, c)    CHG_PORT_PIN_IF(j, i, CHG_LED_ACTIVE_LOW(j))
+#define CHG_VALUE_BIT(j, i, c)  CHG_PORT_PIN_IF(j, i, CHG_LIT(j, c))
+
+/* Channel i leads its port if no earlier channel uses the same controller. */
+#define CHG_EARLIER_BIT(j, i, c) \
+    COND_CODE_1(CHG_LED_EXISTS(j), (((j) < (i) && CHG_LED_SAME_PORT(i, j)) ? 1 : 0), (0))
+#define CHG_LED_LEADS_PORT(i)   (CHG_EACH_CHANNEL(CHG_EARLIER_BIT, i, 0) == 0)
+
+/* One entry per channel; only port leaders carry a non-zero mask and a value table, so each
+ * port is written once and the per-color values exist once per port.
+ */
+struct chg_led_port {
+    const struct device *port;
+    gpio_port_pins_t mask;
+    gpio_port_value_t off;
+    const gpio_port_value_t *value;
+};
+
+#define CHG_PORT_VALUE(c, i)    CHG_EACH_CHANNEL(CHG_VALUE_BIT, i, c)
+#define CHG_PORT_VALUES(i)                                                              \
+    ((const gpio_port_value_t[CHG_COLOR_COUNT]){                                        \
+        FOR_EACH_FIXED_ARG(CHG_PORT_VALUE, (,), i, CHG_COLOR_CODES) })
+#define CHG_PORT_ENTRY(i, ...)                                                          \
+    {                                                                                   \
+        .port  = DEVICE_DT_GET(CHG_LED_CTLR(i)),                                        \
+        .mask  = CHG_LED_LEADS_PORT(i) ? CHG_EACH_CHANNEL(CHG_MASK_BIT, i, 0) : 0,      \
+        .off   = CHG_EACH_CHANNEL(CHG_OFF_BIT, i, 0),                                   \
+        .value = CHG_LED_LEADS_PORT(i) ? CHG_PORT_VALUES(i) : NULL,                     \
+    }
+
+static const struct chg_led_port chg_led_ports[] = {
+    LISTIFY(CHG_LED_COUNT, CHG_PORT_ENTRY, (,))
+};
+
+/* Number of GPIO ports used. With one port every color change is a single (atomic) write. */
+#define CHG_LED_LEADER(i, _)    CHG_LED_LEADS_PORT(i)
+#define CHG_LED_PORT_COUNT      (LISTIFY(CHG_LED_COUNT, CHG_LED_LEADER, (+)))
+
+/* Last color written (CHG_LED_SHOW_OFF: off), for tracing color changes only: the pins may
+ * have been driven by the widget since. Only the LED actor writes, except while it is blocked
+ * (init, system sleep), see indicator_suspend() in charge_indicator.c.
+ */
+static uint8_t chg_led_cur = CHG_LED_SHOW_OFF;
+
+#define CHG_LED_SPEC(i, ...)    GPIO_DT_SPEC_GET(CHG_LED_NODE(i), gpios)
+
+static const struct gpio_dt_spec chg_leds[] = {
+    LISTIFY(CHG_LED_COUNT, CHG_LED_SPEC, (,))
+};
+
+static inline gpio_port_value_t chg_port_value(const struct chg_led_port *p, uint8_t color)
+{
+    return color == CHG_LED_SHOW_OFF ? p->off : p->value[color];
+}
+
+/* Write a color (or CHG_LED_SHOW_OFF) to every port; a change of color is traced.
+ * Across ports, first every port turns off the channels the new color leaves dark, then every
+ * port gets its final value: green -> red passes through dark, never yellow. Neither pass
+ * depends on what was written before, since the widget may have driven the pins meanwhile.
+ * The final pass always writes, so re-applies still override the widget.
+ */
+static void chg_led_write(uint8_t color)
+{
+    if (chg_led_cur != color) {
+        if (color == CHG_LED_SHOW_OFF) {
+            CHG_TRACE(CHG_TR_LED_OFF, 0, 0);
+        } else {
+            CHG_TRACE(CHG_TR_LED_APPLY, color, 0);
+        }
+    }
+    chg_led_cur = color;
+
+    if (CHG_LED_PORT_COUNT > 1) {
+        for (size_t i = 0; i < ARRAY_SIZE(chg_led_ports); i++) {
+            const struct chg_led_port *p = &chg_led_ports[i];
+            if (!p->mask) {
+                continue;
+            }
+            gpio_port_pins_t dark = p->mask & ~(chg_port_value(p, color) ^ p->off);
+            if (dark) {
+                gpio_port_set_masked_raw(p->port, dark, p->off);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(chg_led_ports); i++) {
+        const struct chg_led_port *p = &chg_led_ports[i];
+        if (p->mask) {
+            gpio_port_set_masked_raw(p->port, p->mask, chg_port_value(p, color));
+        }
+    }
+}
+
+void chg_led_apply(uint8_t color)
+{
+    if (color >= CHG_COLOR_COUNT) {
+        color = CHG_COLOR_FALLBACK;
+    }
+
+    chg_led_write(color);
+}
+
+void chg_led_off(void)
+{
+    chg_led_write(CHG_LED_SHOW_OFF);
+}
+
+void chg_led_suspend(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(chg_leds); i++) {
+        (void)gpio_pin_configure_dt(&chg_leds[i], GPIO_DISCONNECTED);
+    }
+}
+
+int chg_led_init(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(chg_leds); i++) {
+        if (!gpio_is_ready_dt(&chg_leds[i])) {
+            LOG_ERR("LED GPIO controller not ready");
+            return -ENODEV;
+        }
+        int ret = gpio_pin_configure_dt(&chg_leds[i], GPIO_OUTPUT_INACTIVE);
+        if (ret) { LOG_ERR("LED%d cfg failed: %d", (int)i, ret); return ret; }
+    }
+    chg_led_cur = CHG_LED_SHOW_OFF;
+    return 0;
+}
+
+#endif /* !CHARGE_INDICATOR_DISABLE_LED */
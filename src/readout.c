@@ -0,0 +1,89 @@
+// src/readout.c
+//
+// Charge Indicator battery readout
+// - Blinks the battery % as tens pulses, a pause, then units pulses (a zero digit is one long pulse).
+// - The whole pulse schedule is computed up front; one delayable work item walks it and posts
+//   each pulse to the LED actor, so a readout costs one wakeup per LED edge and no busy waits.
+// - While active the readout owns the LEDs; at the end they are handed back through chg_refresh().
+//
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <zmk/battery.h>
+
+#include "charge_indicator.h"
+
+LOG_MODULE_DECLARE(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
+
+#define PULSE_ON_MS     200
+#define PULSE_OFF_MS    300
+#define PULSE_LONG_MS   800     /* digit 0 */
+#define DIGIT_GAP_MS    1000
+
+/* Lead-in + 10 tens pulses + 9 units pulses, each an on and an off step. */
+#define CHG_READOUT_MAX_STEPS (1 + 2 * 10 + 2 * 9)
+
+struct chg_pulse {
+    uint16_t ms;
+    uint8_t color;      /* color code, or CHG_LED_SHOW_OFF */
+};
+
+static struct chg_pulse chg_schedule[CHG_READOUT_MAX_STEPS];
+static uint8_t chg_steps, chg_step;
+static atomic_t chg_readout;
+
+bool chg_readout_active(void)
+{
+    return atomic_get(&chg_readout);
+}
+
+static void chg_readout_step(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(chg_readout_work, chg_readout_step);
+
+static void chg_readout_step(struct k_work *work)
+{
+    if (chg_step >= chg_steps) {
+        atomic_clear(&chg_readout);
+        chg_refresh();
+        return;
+    }
+
+    const struct chg_pulse *p = &chg_schedule[chg_step++];
+    chg_led_show(p->color);
+    k_work_schedule(&chg_readout_work, K_MSEC(p->ms));
+}
+
+static void chg_schedule_digit(uint8_t digit, uint8_t color, uint16_t gap_ms)
+{
+    uint8_t pulses = digit ? digit : 1;
+
+    for (uint8_t i = 0; i < pulses; i++) {
+        chg_schedule[chg_steps++] = (struct chg_pulse){ digit ? PULSE_ON_MS : PULSE_LONG_MS, color };
+        chg_schedule[chg_steps++] = (struct chg_pulse){ PULSE_OFF_MS, CHG_LED_SHOW_OFF };
+    }
+    chg_schedule[chg_steps - 1].ms = gap_ms;
+}
+
+void chg_readout_start(void)
+{
+    uint8_t soc = zmk_battery_state_of_charge();
+    if (soc > 100) {
+        return; /* no battery reading */
+    }
+    if (atomic_set(&chg_readout, 1)) {
+        return; /* already running; ignore repeats */
+    }
+
+    CHG_TRACE(CHG_TR_READOUT, soc, 0);
+
+    /* 100 % is shown as ten tens pulses and a zero. */
+    chg_steps = 0;
+    chg_step = 0;
+    chg_schedule[chg_steps++] = (struct chg_pulse){ PULSE_OFF_MS, CHG_LED_SHOW_OFF };
+    chg_schedule_digit(soc / 10, CONFIG_CHG_READOUT_TENS_COLOR, DIGIT_GAP_MS);
+    chg_schedule_digit(soc % 10, CONFIG_CHG_READOUT_UNITS_COLOR, PULSE_OFF_MS);
+    __ASSERT_NO_MSG(chg_steps <= ARRAY_SIZE(chg_schedule));
+
+    k_work_reschedule(&chg_readout_work, K_NO_WAIT);
+}
@@ -0,0 +1,73 @@
+// src/retained.c
+//
+// Charge Indicator retained state
+// - Keeps the last confirmed charging state in __noinit RAM, which survives warm reboots
+//   (reset behaviors, OTA, watchdog) but not power loss.
+// - Guarded by a magic and a CRC; anything else (cold boot, RAM garbage) falls back to the
+//   normal stabilization wait. There is no age check: uptime restarts on every reset, and the
+//   restored state is confirmed against the STAT lines right after boot anyway.
+//
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+
+#include "charge_indicator.h"
+
+LOG_MODULE_DECLARE(charge_indicator, CONFIG_ZMK_LOG_LEVEL);
+
+#define CHG_RETAINED_MAGIC  0x43484732u /* "CHG2", bump when the layout changes */
+
+struct chg_retained {
+    uint32_t magic;
+    uint16_t boots;         /* warm boots since the record was created */
+    uint8_t state;          /* enum chg_state */
+    uint8_t reserved;
+    uint32_t crc;           /* CRC-32 over the fields above */
+};
+
+static __noinit struct chg_retained chg_retained;
+
+/* Checked once on first use during init; a valid record is kept and updated from then on. */
+static bool chg_retained_checked;
+static bool chg_retained_valid;
+
+static uint32_t chg_retained_crc(const struct chg_retained *r)
+{
+    return crc32_ieee((const uint8_t *)r, offsetof(struct chg_retained, crc));
+}
+
+bool chg_retained_get(enum chg_state *state)
+{
+    if (!chg_retained_checked) {
+        chg_retained_checked = true;
+        chg_retained_valid = chg_retained.magic == CHG_RETAINED_MAGIC &&
+                             chg_retained.state <= CHG_STATE_FAULT &&
+                             chg_retained.crc == chg_retained_crc(&chg_retained);
+        if (chg_retained_valid) {
+            LOG_INF("Retained state %d (warm boot %u)", chg_retained.state, chg_retained.boots);
+            chg_retained.boots++;
+            chg_retained.crc = chg_retained_crc(&chg_retained);
+        }
+    }
+
+    if (chg_retained_valid) {
+        *state = (enum chg_state)chg_retained.state;
+    }
+    return chg_retained_valid;
+}
+
+void chg_retained_save(enum chg_state state)
+{
+    if (!chg_retained_valid) {
+        /* Cold boot: start a fresh record. */
+        chg_retained_checked = true;
+        chg_retained_valid = true;
+        chg_retained.boots = 0;
+    }
+
+    chg_retained.magic = CHG_RETAINED_MAGIC;
+    chg_retained.state = state;
+    chg_retained.reserved = 0;
+    chg_retained.crc = chg_retained_crc(&chg_retained);
+}
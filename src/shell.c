@@ -0,0 +1,10 @@
+// src/shell.c
+//
+// Charge Indicator shell root: `chg <subcommand>`.
+// Features add their subcommands with SHELL_SUBCMD_ADD((chg), ...).
+//
+
+#include <zephyr/shell/shell.h>
+
+SHELL_SUBCMD_SET_CREATE(chg_cmds, (chg));
+SHELL_CMD_REGISTER(chg, &chg_cmds, "Charge indicator commands", NULL);
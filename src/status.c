@@ -0,0 +1,66 @@
+// src/status.c
+//
+// Charge Indicator status snapshot (include/zmk_charge_indicator/charge_indicator.h)
+// - One writer (the LED actor) publishes state, band, battery %, last transition time and
+//   fault sources; any context reads them without locks.
+// - Latched sequence counter: two copies, the counter's low bit selects the one readers use
+//   while the other is written. A reader that interrupts the writer (ISR) still finds a
+//   complete copy; only a reader preempted across a whole publish retries.
+// - `chg status` prints the snapshot as other modules see it.
+//
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+#include <zmk_charge_indicator/charge_indicator.h>
+
+#include "charge_indicator.h"
+
+BUILD_ASSERT(ZMK_CHARGE_INDICATOR_IDLE == (int)CHG_STATE_IDLE &&
+             ZMK_CHARGE_INDICATOR_COMPLETE == (int)CHG_STATE_COMPLETE &&
+             ZMK_CHARGE_INDICATOR_CHARGING == (int)CHG_STATE_CHARGING &&
+             ZMK_CHARGE_INDICATOR_FAULT == (int)CHG_STATE_FAULT,
+             "public and internal charging states differ");
+
+static atomic_t chg_status_seq;
+static struct zmk_charge_indicator_status chg_status[2];
+
+void chg_status_publish(const struct zmk_charge_indicator_status *status)
+{
+    /* The atomic increments order the copies: odd -> readers use [1], even -> [0]. */
+    atomic_inc(&chg_status_seq);
+    chg_status[0] = *status;
+    atomic_inc(&chg_status_seq);
+    chg_status[1] = *status;
+}
+
+void zmk_charge_indicator_status_get(struct zmk_charge_indicator_status *status)
+{
+    atomic_val_t seq;
+
+    do {
+        seq = atomic_get(&chg_status_seq);
+        memcpy(status, &chg_status[seq & 1], sizeof(*status));
+        barrier_dmem_fence_full();
+    } while (atomic_get(&chg_status_seq) != seq);
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+static int cmd_status(const struct shell *sh, size_t argc, char **argv)
+{
+    static const char *const states[] = { "idle", "complete", "charging", "fault" };
+    static const char *const bands[] = { "high", "medium", "low", "critical", "missing" };
+    struct zmk_charge_indicator_status status;
+
+    zmk_charge_indicator_status_get(&status);
+    shell_print(sh, "state %s, band %s, soc %u%%, since %ums, faults 0x%08x",
+                status.state < ARRAY_SIZE(states) ? states[status.state] : "?",
+                status.band < ARRAY_SIZE(bands) ? bands[status.band] : "?",
+                status.soc, k_uptime_get_32() - status.transition_ms, status.fault_sources);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((chg), status, NULL, "Status snapshot as seen by other modules", cmd_status, 1, 0);
+#endif
@@ -0,0 +1,139 @@
+// src/trace.c
+//
+// Charge Indicator trace ring
+// - Hot paths (LED changes, STAT edges, state changes) record 8-byte binary events instead of
+//   formatting log text: a cycle timestamp and three stores, safe from ISRs. Periodic re-applies
+//   that change nothing are not recorded, so they cannot flush the ring.
+// - The ring keeps the last CONFIG_CHG_TRACE_RECORDS events; the oldest are overwritten.
+// - `chg trace` prints them, `chg trace raw` dumps them for scripts/chg_trace_decode.py.
+// - With CONFIG_CHG_TRACING the same events go to Zephyr tracing (CTF, SystemView) as named
+//   events, so they show up next to kscan and BLE in a timeline.
+//
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/tracing/tracing.h>
+
+#include "charge_indicator.h"
+
+static const char *const chg_trace_names[CHG_TR_COUNT] __maybe_unused = {
+    [CHG_TR_LED_APPLY] = "chg_led_apply",
+    [CHG_TR_LED_OFF] = "chg_led_off",
+    [CHG_TR_BAND] = "chg_band",
+    [CHG_TR_STAT_EDGE] = "chg_stat_edge",
+    [CHG_TR_STAT_CONFIRM] = "chg_stat_confirm",
+    [CHG_TR_STATE] = "chg_state",
+    [CHG_TR_SHOW_BATTERY] = "chg_show_battery",
+    [CHG_TR_READOUT] = "chg_readout",
+    [CHG_TR_DISPLAY] = "chg_display",
+    [CHG_TR_ACTIVITY] = "chg_activity",
+    [CHG_TR_ISR_ENTER] = "chg_isr_enter",
+    [CHG_TR_ISR_EXIT] = "chg_isr_exit",
+    [CHG_TR_OVERRIDE] = "chg_override",
+};
+
+/* Name of an event; NULL if it has none. */
+static inline const char *chg_trace_name(uint8_t event)
+{
+    return event < ARRAY_SIZE(chg_trace_names) ? chg_trace_names[event] : NULL;
+}
+
+#if IS_ENABLED(CONFIG_CHG_TRACE)
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_CHG_TRACE_RECORDS), "CONFIG_CHG_TRACE_RECORDS must be a power of two");
+
+/* Keep in sync with scripts/chg_trace_decode.py. */
+struct chg_trace_record {
+    uint32_t cycles;        /* k_cycle_get_32() */
+    uint8_t event;          /* enum chg_trace_event, 0 = empty slot */
+    uint8_t a;
+    uint16_t b;
+} __packed;
+
+BUILD_ASSERT(sizeof(struct chg_trace_record) == 8, "trace record layout changed");
+
+static struct chg_trace_record chg_trace_ring[CONFIG_CHG_TRACE_RECORDS];
+static atomic_t chg_trace_head;
+#endif
+
+void chg_trace(uint8_t event, uint8_t a, uint16_t b)
+{
+#if IS_ENABLED(CONFIG_CHG_TRACE)
+    uint32_t idx = (uint32_t)atomic_inc(&chg_trace_head) & (CONFIG_CHG_TRACE_RECORDS - 1);
+    struct chg_trace_record *rec = &chg_trace_ring[idx];
+
+    rec->cycles = k_cycle_get_32();
+    rec->event = event;
+    rec->a = a;
+    rec->b = b;
+#endif
+#if IS_ENABLED(CONFIG_CHG_TRACING)
+    const char *name = chg_trace_name(event);
+    if (name != NULL) {
+        sys_trace_named_event(name, a, b);
+    }
+#endif
+}
+
+#if IS_ENABLED(CONFIG_CHG_TRACE)
+void chg_trace_clear(void)
+{
+    memset(chg_trace_ring, 0, sizeof(chg_trace_ring));
+    atomic_clear(&chg_trace_head);
+}
+#endif
+
+#if IS_ENABLED(CONFIG_CHG_TRACE) && IS_ENABLED(CONFIG_SHELL)
+/* Oldest first. The ring is read while tracing continues; a record written during the dump
+ * may show up torn, which is acceptable for diagnostics.
+ */
+static int chg_trace_dump(const struct shell *sh, bool raw)
+{
+    uint32_t head = atomic_get(&chg_trace_head);
+    uint32_t count = MIN(head, CONFIG_CHG_TRACE_RECORDS);
+    uint32_t hz = sys_clock_hw_cycles_per_sec();
+
+    if (raw) {
+        shell_print(sh, "hz %u", hz);
+    }
+    for (uint32_t i = head - count; i != head; i++) {
+        struct chg_trace_record rec = chg_trace_ring[i & (CONFIG_CHG_TRACE_RECORDS - 1)];
+        if (rec.event == 0) {
+            continue;
+        }
+        if (raw) {
+            shell_hexdump_line(sh, 0, (const uint8_t *)&rec, sizeof(rec));
+        } else {
+            const char *name = chg_trace_name(rec.event);
+            shell_print(sh, "%10u us  %-13s a=%u b=%u",
+                        (uint32_t)((uint64_t)rec.cycles * USEC_PER_SEC / hz), name ? name : "?", rec.a, rec.b);
+        }
+    }
+    return 0;
+}
+
+static int cmd_trace_list(const struct shell *sh, size_t argc, char **argv)
+{
+    return chg_trace_dump(sh, false);
+}
+
+static int cmd_trace_raw(const struct shell *sh, size_t argc, char **argv)
+{
+    return chg_trace_dump(sh, true);
+}
+
+static int cmd_trace_clear(const struct shell *sh, size_t argc, char **argv)
+{
+    chg_trace_clear();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(chg_trace_cmds,
+    SHELL_CMD(list, NULL, "List trace events (oldest first)", cmd_trace_list),
+    SHELL_CMD(raw, NULL, "Dump trace records as hex (scripts/chg_trace_decode.py)", cmd_trace_raw),
+    SHELL_CMD(clear, NULL, "Clear the trace ring", cmd_trace_clear),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chg), trace, &chg_trace_cmds, "Hot-path event trace", cmd_trace_list, 1, 0);
+#endif
@@ -0,0 +1,197 @@
+// tests/bounce/src/main.c
+//
+// Random bounce sequences on two emulated STAT lines, through the real chg-stat driver, the
+// indicator core and the LED actor. Each run must end on the settled levels, notify the core
+// only for real changes and update the LEDs at most once per confirmed combined transition.
+// The driver itself asserts (CONFIG_ASSERT) that every confirmation waited for the debounce
+// window and came within CONFIG_CHG_CONFIRM_LATENCY_MAX_MS after it.
+//
+
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/shell/shell_dummy.h>
+
+#include "charge_indicator.h"
+
+#define RUNS        200
+#define MAX_EDGES   16
+
+#define A_NODE      DT_NODELABEL(chg_a)
+#define B_NODE      DT_NODELABEL(chg_b)
+
+/* Quiet time after the last edge: every window has closed and the actor has run. */
+#define QUIET_MS    (2 * MAX(DT_PROP(A_NODE, debounce_ms), DT_PROP(B_NODE, debounce_ms)) + 20)
+
+static const struct device *const devs[] = {
+    DEVICE_DT_GET(A_NODE),
+    DEVICE_DT_GET(B_NODE),
+};
+static const struct gpio_dt_spec pins[] = {
+    GPIO_DT_SPEC_GET(A_NODE, gpios),
+    GPIO_DT_SPEC_GET(B_NODE, gpios),
+};
+static const uint32_t debounce_ms[] = {
+    DT_PROP(A_NODE, debounce_ms),
+    DT_PROP(B_NODE, debounce_ms),
+};
+static const struct gpio_dt_spec leds[] = {
+    GPIO_DT_SPEC_GET(DT_NODELABEL(led_r), gpios),
+    GPIO_DT_SPEC_GET(DT_NODELABEL(led_g), gpios),
+    GPIO_DT_SPEC_GET(DT_NODELABEL(led_b), gpios),
+};
+
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    /* xorshift32: a fixed seed keeps failures reproducible. */
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi)
+{
+    return lo + rng() % (hi - lo + 1);
+}
+
+static enum chg_state state_of(const struct device *dev)
+{
+    const struct chg_stat_driver_api *api = dev->api;
+
+    return api->get_state(dev);
+}
+
+/* Color code shown on the pins (default table: channel bitmask, 0 = off). */
+static int led_color(void)
+{
+    int color = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(leds); i++) {
+        if (gpio_emul_output_get(leds[i].port, leds[i].pin) > 0) {
+            color |= BIT(i);
+        }
+    }
+    return color;
+}
+
+/* Sleep ms, sampling the LED pins every millisecond; returns the number of color changes. */
+static int sleep_sampling(uint32_t ms, int *last)
+{
+    int changes = 0;
+
+    for (uint32_t t = 0; t < ms; t++) {
+        k_sleep(K_MSEC(1));
+        int color = led_color();
+        if (color != *last) {
+            changes++;
+            *last = color;
+        }
+    }
+    return changes;
+}
+
+/* Run a shell command; returns its output. */
+static const char *chg_cmd(const char *cmd)
+{
+    const struct shell *sh = shell_backend_dummy_get_ptr();
+    size_t size;
+
+    shell_backend_dummy_clear_output(sh);
+    zassert_ok(shell_execute_cmd(sh, cmd), "`%s` failed", cmd);
+    return shell_backend_dummy_get_output(sh, &size);
+}
+
+static int count_of(const char *text, const char *word)
+{
+    int n = 0;
+
+    for (const char *p = strstr(text, word); p != NULL; p = strstr(p + 1, word)) {
+        n++;
+    }
+    return n;
+}
+
+static void *bounce_setup(void)
+{
+    const struct shell *sh = shell_backend_dummy_get_ptr();
+
+    for (size_t s = 0; s < ARRAY_SIZE(devs); s++) {
+        zassert_true(device_is_ready(devs[s]));
+    }
+    zassert_true(WAIT_FOR(shell_ready(sh), 1000000, k_msleep(1)));
+    return NULL;
+}
+
+ZTEST(bounce, test_random_edges)
+{
+    rng_state = 0x2545f491;
+
+    for (int run = 0; run < RUNS; run++) {
+        /* Both unplugged (high) and settled, empty trace. */
+        uint8_t level[2] = { 1, 1 };
+        int toggles[2] = { 0, 0 };
+        int last = led_color();
+        int led_changes = 0;
+        size_t edges = rng_range(1, MAX_EDGES);
+
+        chg_cmd("chg trace clear");
+        for (size_t i = 0; i < edges; i++) {
+            size_t s = rng() & 1;
+            /* Mostly bounces shorter than the debounce, sometimes a settled level. */
+            uint32_t gap = rng() % 4 ? rng_range(1, debounce_ms[s])
+                                     : rng_range(debounce_ms[s], 4 * debounce_ms[s]);
+
+            led_changes += sleep_sampling(gap, &last);
+            level[s] ^= 1;
+            toggles[s]++;
+            zassert_ok(gpio_emul_input_set(pins[s].port, pins[s].pin, level[s]));
+        }
+        led_changes += sleep_sampling(QUIET_MS, &last);
+
+        /* The settled levels win, and the LEDs show the combined state. */
+        for (size_t s = 0; s < ARRAY_SIZE(devs); s++) {
+            zassert_equal(state_of(devs[s]), level[s] ? CHG_STATE_IDLE : CHG_STATE_CHARGING,
+                          "run %d: source %u", run, (unsigned)s);
+        }
+        bool charging = !level[0] || !level[1];
+        zassert_equal(led_color(), charging ? CONFIG_CHG_COLOR : 0, "run %d", run);
+
+        const char *trace = chg_cmd("chg trace");
+        int confirms[2] = {
+            count_of(trace, "chg_stat_confirm a=0 "),
+            count_of(trace, "chg_stat_confirm a=1 "),
+        };
+        int transitions = count_of(trace, "chg_state ");
+        int led_updates = count_of(trace, "chg_led_apply ") + count_of(trace, "chg_led_off ");
+
+        /* Notifications: each one a real change of its source, so never more than the line
+         * toggled, and an odd number exactly when it ended on the other level.
+         */
+        for (size_t s = 0; s < ARRAY_SIZE(devs); s++) {
+            zassert_true(confirms[s] <= toggles[s], "run %d: source %u: %d notifications for "
+                         "%d toggles\n%s", run, (unsigned)s, confirms[s], toggles[s], trace);
+            zassert_equal(confirms[s] % 2, toggles[s] % 2, "run %d: source %u\n%s", run,
+                          (unsigned)s, trace);
+        }
+        zassert_true(transitions <= confirms[0] + confirms[1], "run %d\n%s", run, trace);
+        /* At most one LED update per confirmed transition, and nothing else on the pins. */
+        zassert_true(led_updates <= transitions, "run %d: %d LED updates for %d transitions\n%s",
+                     run, led_updates, transitions, trace);
+        zassert_true(led_changes <= led_updates, "run %d: %d LED changes seen", run,
+                     led_changes);
+
+        /* Unplug both for the next run. */
+        for (size_t s = 0; s < ARRAY_SIZE(devs); s++) {
+            zassert_ok(gpio_emul_input_set(pins[s].port, pins[s].pin, 1));
+        }
+        k_sleep(K_MSEC(QUIET_MS));
+    }
+}
+
+ZTEST_SUITE(bounce, NULL, bounce_setup, NULL, NULL, NULL);
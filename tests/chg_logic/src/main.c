@@ -0,0 +1,111 @@
+// tests/chg_logic/src/main.c
+//
+// Host checks of the pure decisions in chg_logic.h: debounce window arithmetic (across the
+// uptime wrap), boot reads, combine policies against their definitions and the poll bounds.
+// Bounce sequences run through the real driver in tests/bounce.
+//
+
+#include <stdlib.h>
+#include <zephyr/ztest.h>
+
+#include "chg_logic.h"
+
+#define RUNS            2000
+
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    /* xorshift32: fixed seeds keep failures reproducible. */
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi)
+{
+    return lo + rng() % (hi - lo + 1);
+}
+
+ZTEST(chg_logic, test_debounce_settled_wraps)
+{
+    zassert_true(chg_debounce_settled(5, UINT32_MAX - 2, 8));
+    zassert_false(chg_debounce_settled(4, UINT32_MAX - 2, 8));
+    zassert_true(chg_debounce_settled(100, 100, 0));
+    zassert_false(chg_debounce_settled(100, 100, 1));
+}
+
+ZTEST(chg_logic, test_boot_reads)
+{
+    for (int s1 = CHG_STATE_IDLE; s1 <= CHG_STATE_FAULT; s1++) {
+        for (int s2 = CHG_STATE_IDLE; s2 <= CHG_STATE_FAULT; s2++) {
+            enum chg_state state = chg_boot_state(s1, s2);
+            enum chg_state want = s1 == s2 ? (enum chg_state)s1 : CHG_STATE_IDLE;
+
+            zassert_equal(state, want);
+            zassert_equal(chg_boot_needs_confirm(s1, s2), s1 != s2);
+        }
+    }
+}
+
+ZTEST(chg_logic, test_random_combine)
+{
+    rng_state = 0x9e3779b9;
+
+    for (int run = 0; run < RUNS; run++) {
+        size_t n = rng_range(1, 6);
+        enum chg_state s[6];
+        int32_t prio[6];
+        struct chg_combine any, all, pri;
+
+        chg_combine_init(&any);
+        chg_combine_init(&all);
+        chg_combine_init(&pri);
+
+        enum chg_state max = CHG_STATE_IDLE, min = CHG_STATE_FAULT, want_pri = CHG_STATE_IDLE;
+        int32_t best = INT32_MIN;
+
+        for (size_t i = 0; i < n; i++) {
+            s[i] = rng() % 4;
+            prio[i] = (int32_t)rng_range(0, 3) - 1;
+            chg_combine_add(&any, CHG_COMBINE_POLICY_ANY, s[i], prio[i]);
+            chg_combine_add(&all, CHG_COMBINE_POLICY_ALL, s[i], prio[i]);
+            chg_combine_add(&pri, CHG_COMBINE_POLICY_PRIORITY, s[i], prio[i]);
+
+            max = MAX(max, s[i]);
+            min = MIN(min, s[i]);
+            /* The first source of the highest priority that is not idle decides. */
+            if (s[i] != CHG_STATE_IDLE && prio[i] > best) {
+                best = prio[i];
+                want_pri = s[i];
+            }
+        }
+
+        zassert_equal(any.state, max, "run %d", run);
+        zassert_equal(all.state, min, "run %d", run);
+        zassert_equal(pri.state, want_pri, "run %d", run);
+
+        /* Any and all do not depend on the order of the sources. */
+        struct chg_combine rev_any, rev_all;
+        chg_combine_init(&rev_any);
+        chg_combine_init(&rev_all);
+        for (size_t i = n; i-- > 0;) {
+            chg_combine_add(&rev_any, CHG_COMBINE_POLICY_ANY, s[i], prio[i]);
+            chg_combine_add(&rev_all, CHG_COMBINE_POLICY_ALL, s[i], prio[i]);
+        }
+        zassert_equal(rev_any.state, any.state, "run %d", run);
+        zassert_equal(rev_all.state, all.state, "run %d", run);
+    }
+}
+
+ZTEST(chg_logic, test_poll_bounds)
+{
+    for (uint32_t poll = 1; poll <= 4096; poll *= 2) {
+        zassert_equal(chg_poll_next(poll, true, 50, 2000), 50);
+        uint32_t next = chg_poll_next(poll, false, 50, 2000);
+        zassert_true(next <= 2000 && (next >= poll || poll > 2000));
+    }
+}
+
+ZTEST_SUITE(chg_logic, NULL, NULL, NULL, NULL, NULL);
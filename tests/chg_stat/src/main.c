@@ -0,0 +1,133 @@
+// tests/chg_stat/src/main.c
+//
+// custom,chg-stat on emulated GPIOs: wakeup configuration around PM suspend and the post-wake
+// path (level interrupt -> back to edges -> resume re-confirms the state).
+//
+
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/pm/device.h>
+
+#include "charge_indicator.h"
+#include "stubs.h"
+
+#define WAKE_NODE   DT_NODELABEL(chg_wake)
+#define PLAIN_NODE  DT_NODELABEL(chg_plain)
+
+/* Longer than the default 8 ms debounce plus work queue latency. */
+#define SETTLE      K_MSEC(50)
+
+static const struct device *const wake_dev = DEVICE_DT_GET(WAKE_NODE);
+static const struct device *const plain_dev = DEVICE_DT_GET(PLAIN_NODE);
+static const struct gpio_dt_spec wake_pin = GPIO_DT_SPEC_GET(WAKE_NODE, gpios);
+static const struct gpio_dt_spec plain_pin = GPIO_DT_SPEC_GET(PLAIN_NODE, gpios);
+
+static enum chg_state state_of(const struct device *dev)
+{
+    const struct chg_stat_driver_api *api = dev->api;
+
+    return api->get_state(dev);
+}
+
+static void set_level(const struct gpio_dt_spec *spec, int level)
+{
+    zassert_ok(gpio_emul_input_set(spec->port, spec->pin, level));
+}
+
+/* Interrupt configuration of a pin as last set through the GPIO API. */
+static gpio_flags_t int_flags(const struct gpio_dt_spec *spec)
+{
+    gpio_flags_t flags;
+
+    zassert_ok(gpio_emul_flags_get(spec->port, spec->pin, &flags));
+    return flags & (GPIO_INT_ENABLE | GPIO_INT_EDGE | GPIO_INT_LOW_0 | GPIO_INT_HIGH_1);
+}
+
+#define INT_EDGE_BOTH   (GPIO_INT_ENABLE | GPIO_INT_EDGE | GPIO_INT_LOW_0 | GPIO_INT_HIGH_1)
+
+static void *chg_stat_setup(void)
+{
+    zassert_true(device_is_ready(wake_dev));
+    zassert_true(device_is_ready(plain_dev));
+    return NULL;
+}
+
+/* Every test starts unplugged, resumed, with wakeup enabled as in devicetree. */
+static void chg_stat_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    (void)pm_device_action_run(wake_dev, PM_DEVICE_ACTION_RESUME);
+    (void)pm_device_action_run(plain_dev, PM_DEVICE_ACTION_RESUME);
+    pm_device_wakeup_enable(wake_dev, true);
+    set_level(&wake_pin, 1);
+    set_level(&plain_pin, 1);
+    k_sleep(SETTLE);
+    atomic_clear(&chg_test_notified);
+}
+
+ZTEST(chg_stat, test_wakeup_source_from_devicetree)
+{
+    zassert_true(pm_device_wakeup_is_capable(wake_dev));
+    zassert_true(pm_device_wakeup_is_enabled(wake_dev));
+    zassert_false(pm_device_wakeup_is_capable(plain_dev));
+}
+
+ZTEST(chg_stat, test_edge_confirms_after_debounce)
+{
+    zassert_equal(int_flags(&wake_pin), INT_EDGE_BOTH);
+    zassert_equal(state_of(wake_dev), CHG_STATE_IDLE);
+
+    set_level(&wake_pin, 0);
+    k_sleep(SETTLE);
+    zassert_equal(state_of(wake_dev), CHG_STATE_CHARGING);
+    zassert_equal(atomic_get(&chg_test_notified), 1);
+}
+
+ZTEST(chg_stat, test_suspend_arms_opposite_level)
+{
+    /* Unplugged (high): wake on low. */
+    zassert_ok(pm_device_action_run(wake_dev, PM_DEVICE_ACTION_SUSPEND));
+    zassert_equal(int_flags(&wake_pin), GPIO_INT_ENABLE | GPIO_INT_LOW_0);
+
+    /* Not a wakeup source: interrupt off while suspended. */
+    zassert_ok(pm_device_action_run(plain_dev, PM_DEVICE_ACTION_SUSPEND));
+    zassert_false(int_flags(&plain_pin) & GPIO_INT_ENABLE);
+
+    /* Plugged (low): wake on high. */
+    zassert_ok(pm_device_action_run(wake_dev, PM_DEVICE_ACTION_RESUME));
+    set_level(&wake_pin, 0);
+    k_sleep(SETTLE);
+    zassert_ok(pm_device_action_run(wake_dev, PM_DEVICE_ACTION_SUSPEND));
+    zassert_equal(int_flags(&wake_pin), GPIO_INT_ENABLE | GPIO_INT_HIGH_1);
+}
+
+ZTEST(chg_stat, test_wakeup_disabled_at_runtime)
+{
+    zassert_true(pm_device_wakeup_enable(wake_dev, false));
+    zassert_ok(pm_device_action_run(wake_dev, PM_DEVICE_ACTION_SUSPEND));
+    zassert_false(int_flags(&wake_pin) & GPIO_INT_ENABLE);
+}
+
+ZTEST(chg_stat, test_plug_in_wake_path)
+{
+    zassert_ok(pm_device_action_run(wake_dev, PM_DEVICE_ACTION_SUSPEND));
+
+    /* Plug in while suspended: the level interrupt fires and the pin goes back to edges, so it
+     * cannot fire again while the line stays low.
+     */
+    set_level(&wake_pin, 0);
+    zassert_equal(int_flags(&wake_pin), INT_EDGE_BOTH);
+
+    /* The wake edge is debounced like any other; resume re-reads without a second report. */
+    k_sleep(SETTLE);
+    zassert_equal(state_of(wake_dev), CHG_STATE_CHARGING);
+    zassert_ok(pm_device_action_run(wake_dev, PM_DEVICE_ACTION_RESUME));
+    k_sleep(SETTLE);
+    zassert_equal(state_of(wake_dev), CHG_STATE_CHARGING);
+    zassert_equal(atomic_get(&chg_test_notified), 1);
+}
+
+ZTEST_SUITE(chg_stat, NULL, chg_stat_setup, chg_stat_before, NULL, NULL);
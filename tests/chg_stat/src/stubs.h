@@ -0,0 +1,8 @@
+// tests/chg_stat/src/stubs.h
+
+#pragma once
+
+#include <zephyr/sys/atomic.h>
+
+/* chg_stat_notify() calls since the last reset. */
+extern atomic_t chg_test_notified;
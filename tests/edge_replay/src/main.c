@@ -0,0 +1,187 @@
+// tests/edge_replay/src/main.c
+//
+// `chg edges` on emulated GPIOs with the real indicator core: sources are told apart by instance
+// even when they share a pin number, a replay reaches the LEDs in the expected order, and its
+// trace is not flushed by the LED actor's periodic re-applies.
+//
+
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/shell/shell_dummy.h>
+
+#include "charge_indicator.h"
+
+#define A_NODE  DT_NODELABEL(chg_a)
+#define B_NODE  DT_NODELABEL(chg_b)
+
+/* Longer than the default 8 ms debounce plus work queue latency. */
+#define SETTLE  K_MSEC(50)
+
+/* Replays cap idle gaps at this, so one ends GAP_MS after its last step. */
+#define GAP_MS  100
+
+static const struct device *const a_dev = DEVICE_DT_GET(A_NODE);
+static const struct device *const b_dev = DEVICE_DT_GET(B_NODE);
+static const struct gpio_dt_spec a_pin = GPIO_DT_SPEC_GET(A_NODE, gpios);
+static const struct gpio_dt_spec b_pin = GPIO_DT_SPEC_GET(B_NODE, gpios);
+static const struct gpio_dt_spec leds[] = {
+    GPIO_DT_SPEC_GET(DT_NODELABEL(led_r), gpios),
+    GPIO_DT_SPEC_GET(DT_NODELABEL(led_g), gpios),
+    GPIO_DT_SPEC_GET(DT_NODELABEL(led_b), gpios),
+};
+
+static enum chg_state state_of(const struct device *dev)
+{
+    const struct chg_stat_driver_api *api = dev->api;
+
+    return api->get_state(dev);
+}
+
+static void set_level(const struct gpio_dt_spec *spec, int level)
+{
+    zassert_ok(gpio_emul_input_set(spec->port, spec->pin, level));
+}
+
+/* Color code shown on the pins (default table: channel bitmask, 0 = off). */
+static int led_color(void)
+{
+    int color = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(leds); i++) {
+        if (gpio_emul_output_get(leds[i].port, leds[i].pin) > 0) {
+            color |= BIT(i);
+        }
+    }
+    return color;
+}
+
+/* Run a shell command; returns its output. */
+static const char *chg_cmd(const char *cmd)
+{
+    const struct shell *sh = shell_backend_dummy_get_ptr();
+    size_t size;
+
+    shell_backend_dummy_clear_output(sh);
+    zassert_ok(shell_execute_cmd(sh, cmd), "`%s` failed", cmd);
+    return shell_backend_dummy_get_output(sh, &size);
+}
+
+static int count_of(const char *text, const char *word)
+{
+    int n = 0;
+
+    for (const char *p = strstr(text, word); p != NULL; p = strstr(p + 1, word)) {
+        n++;
+    }
+    return n;
+}
+
+/* Sample the LED pins every millisecond for duration_ms; record each change of color. */
+static size_t led_timeline(int *out, size_t max, uint32_t duration_ms)
+{
+    size_t n = 0;
+    int last = led_color();
+
+    for (uint32_t t = 0; t < duration_ms; t++) {
+        k_sleep(K_MSEC(1));
+        int color = led_color();
+        if (color != last && n < max) {
+            out[n++] = color;
+        }
+        last = color;
+    }
+    return n;
+}
+
+static void *edge_replay_setup(void)
+{
+    const struct shell *sh = shell_backend_dummy_get_ptr();
+
+    zassert_true(device_is_ready(a_dev));
+    zassert_true(device_is_ready(b_dev));
+    zassert_true(WAIT_FOR(shell_ready(sh), 1000000, k_msleep(1)));
+    return NULL;
+}
+
+/* Every test starts unplugged, with an empty capture, script and trace. */
+static void edge_replay_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    set_level(&a_pin, 1);
+    set_level(&b_pin, 1);
+    k_sleep(SETTLE);
+    chg_cmd("chg edges clear");
+    chg_cmd("chg trace clear");
+}
+
+ZTEST(edge_replay, test_inject_by_source_not_pin)
+{
+    zassert_equal(a_pin.pin, b_pin.pin, "the sources must share a pin number");
+
+    chg_cmd("chg edges push 1 0 0");
+    chg_cmd("chg edges run " STRINGIFY(GAP_MS));
+    k_sleep(SETTLE);
+    zassert_equal(state_of(b_dev), CHG_STATE_CHARGING);
+    zassert_equal(state_of(a_dev), CHG_STATE_IDLE);
+    zassert_equal(led_color(), CONFIG_CHG_COLOR);
+
+    /* The end of the replay hands the pins back: both unplugged again. */
+    k_sleep(K_MSEC(GAP_MS + 50));
+    zassert_equal(state_of(b_dev), CHG_STATE_IDLE);
+    zassert_equal(led_color(), 0);
+
+    /* The trace names the instance too: only source 1 confirmed anything. */
+    const char *trace = chg_cmd("chg trace");
+    zassert_equal(count_of(trace, "chg_stat_confirm a=1 "), 2, "%s", trace);
+    zassert_equal(count_of(trace, "chg_stat_confirm a=0 "), 0, "%s", trace);
+}
+
+ZTEST(edge_replay, test_capture_records_source)
+{
+    set_level(&b_pin, 0);
+    k_sleep(SETTLE);
+    set_level(&b_pin, 1);
+    k_sleep(SETTLE);
+
+    const char *list = chg_cmd("chg edges list");
+    zassert_equal(count_of(list, "src 1 -> "), 2, "%s", list);
+    zassert_equal(count_of(list, "src 0 -> "), 0, "%s", list);
+
+    /* Loaded back, the capture moves the same instance. */
+    chg_cmd("chg edges load");
+    chg_cmd("chg edges run " STRINGIFY(GAP_MS));
+    k_sleep(K_MSEC(25));
+    zassert_equal(state_of(b_dev), CHG_STATE_CHARGING);
+    zassert_equal(state_of(a_dev), CHG_STATE_IDLE);
+    k_sleep(K_MSEC(2 * GAP_MS));
+}
+
+ZTEST(edge_replay, test_replay_led_timeline)
+{
+    int timeline[8];
+
+    /* A 5 ms bounce (not confirmed), then a 50 ms plug-in on source 0. */
+    chg_cmd("chg edges push 0 0 0");
+    chg_cmd("chg edges push 0 1 5");
+    chg_cmd("chg edges push 0 0 50");
+    chg_cmd("chg edges push 0 1 50");
+    chg_cmd("chg edges run " STRINGIFY(GAP_MS));
+
+    size_t n = led_timeline(timeline, ARRAY_SIZE(timeline), 105 + 2 * GAP_MS);
+    zassert_equal(n, 2, "%u LED changes", (unsigned)n);
+    zassert_equal(timeline[0], CONFIG_CHG_COLOR);
+    zassert_equal(timeline[1], 0);
+
+    /* The ring holds the whole replay: the 150 ms re-applies while charging are not traced. */
+    const char *trace = chg_cmd("chg trace");
+    zassert_equal(count_of(trace, "chg_state "), 2, "%s", trace);
+    zassert_equal(count_of(trace, "chg_led_apply "), 1, "%s", trace);
+    zassert_equal(count_of(trace, "chg_led_off "), 1, "%s", trace);
+}
+
+ZTEST_SUITE(edge_replay, NULL, edge_replay_setup, edge_replay_before, NULL, NULL);
@@ -0,0 +1,136 @@
+// tests/soft_off/src/main.c
+//
+// Keyboard sleep the way ZMK does it (SLEEP event, then zmk_pm_soft_off()) with the real core:
+// by the time soft off would power down, wakeup sources wait on a level interrupt for the
+// opposite level, other inputs are quiet and the LEDs are dark. A failed soft off goes back
+// to edges.
+//
+
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/pm/device.h>
+#include <zmk/activity.h>
+#include <zmk_stub.h>
+
+#include "charge_indicator.h"
+
+#define WAKE_NODE   DT_NODELABEL(chg_wake)
+#define PLAIN_NODE  DT_NODELABEL(chg_plain)
+
+/* Longer than the default 8 ms debounce plus work queue latency. */
+#define SETTLE      K_MSEC(50)
+
+static const struct device *const wake_dev = DEVICE_DT_GET(WAKE_NODE);
+static const struct device *const plain_dev = DEVICE_DT_GET(PLAIN_NODE);
+static const struct gpio_dt_spec wake_pin = GPIO_DT_SPEC_GET(WAKE_NODE, gpios);
+static const struct gpio_dt_spec plain_pin = GPIO_DT_SPEC_GET(PLAIN_NODE, gpios);
+static const struct gpio_dt_spec leds[] = {
+    GPIO_DT_SPEC_GET(DT_NODELABEL(led_r), gpios),
+    GPIO_DT_SPEC_GET(DT_NODELABEL(led_g), gpios),
+    GPIO_DT_SPEC_GET(DT_NODELABEL(led_b), gpios),
+};
+
+static void set_level(const struct gpio_dt_spec *spec, int level)
+{
+    zassert_ok(gpio_emul_input_set(spec->port, spec->pin, level));
+}
+
+/* Interrupt configuration of a pin as last set through the GPIO API. */
+static gpio_flags_t int_flags(const struct gpio_dt_spec *spec)
+{
+    gpio_flags_t flags;
+
+    zassert_ok(gpio_emul_flags_get(spec->port, spec->pin, &flags));
+    return flags & (GPIO_INT_ENABLE | GPIO_INT_EDGE | GPIO_INT_LOW_0 | GPIO_INT_HIGH_1);
+}
+
+#define INT_EDGE_BOTH   (GPIO_INT_ENABLE | GPIO_INT_EDGE | GPIO_INT_LOW_0 | GPIO_INT_HIGH_1)
+
+/* Color code shown on the pins (default table: channel bitmask, 0 = off or released). */
+static int led_color(void)
+{
+    int color = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(leds); i++) {
+        if (gpio_emul_output_get(leds[i].port, leds[i].pin) > 0) {
+            color |= BIT(i);
+        }
+    }
+    return color;
+}
+
+static void *soft_off_setup(void)
+{
+    zassert_true(device_is_ready(wake_dev));
+    zassert_true(device_is_ready(plain_dev));
+    return NULL;
+}
+
+/* Every test starts awake and unplugged, with wakeup enabled as in devicetree (soft off
+ * disables it on every device).
+ */
+static void soft_off_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    zmk_stub_soft_off_ret = 0;
+    zmk_stub_activity_set(ZMK_ACTIVITY_ACTIVE);
+    pm_device_wakeup_enable(wake_dev, true);
+    set_level(&wake_pin, 1);
+    set_level(&plain_pin, 1);
+    k_sleep(SETTLE);
+}
+
+ZTEST(soft_off, test_sleep_arms_wake_level)
+{
+    zassert_equal(int_flags(&wake_pin), INT_EDGE_BOTH);
+
+    zassert_ok(zmk_stub_sleep());
+
+    /* Unplugged (high): wake on low. Soft off disabled wakeup on the device afterwards, and
+     * found it already suspended.
+     */
+    zassert_false(pm_device_wakeup_is_enabled(wake_dev));
+    zassert_equal(int_flags(&wake_pin), GPIO_INT_ENABLE | GPIO_INT_LOW_0);
+    /* Not a wakeup source: interrupt off. */
+    zassert_false(int_flags(&plain_pin) & GPIO_INT_ENABLE);
+}
+
+ZTEST(soft_off, test_sleep_while_charging)
+{
+    set_level(&wake_pin, 0);
+    k_sleep(SETTLE);
+    zassert_equal(led_color(), CONFIG_CHG_COLOR);
+
+    zassert_ok(zmk_stub_sleep());
+
+    /* Plugged (low): wake on unplug, LEDs dark before powering off. */
+    zassert_equal(int_flags(&wake_pin), GPIO_INT_ENABLE | GPIO_INT_HIGH_1);
+    zassert_equal(led_color(), 0);
+}
+
+ZTEST(soft_off, test_wakeup_disabled_at_runtime)
+{
+    zassert_true(pm_device_wakeup_enable(wake_dev, false));
+
+    zassert_ok(zmk_stub_sleep());
+    zassert_false(int_flags(&wake_pin) & GPIO_INT_ENABLE);
+}
+
+ZTEST(soft_off, test_soft_off_failed)
+{
+    zmk_stub_soft_off_ret = -EIO;
+
+    zassert_equal(zmk_stub_sleep(), -EIO);
+
+    /* Active again: both inputs back on edges, and a plug-in shows as usual. */
+    zassert_equal(int_flags(&wake_pin), INT_EDGE_BOTH);
+    zassert_equal(int_flags(&plain_pin), INT_EDGE_BOTH);
+    set_level(&plain_pin, 0);
+    k_sleep(SETTLE);
+    zassert_equal(led_color(), CONFIG_CHG_COLOR);
+}
+
+ZTEST_SUITE(soft_off, NULL, soft_off_setup, soft_off_before, NULL, NULL);
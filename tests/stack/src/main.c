@@ -0,0 +1,65 @@
+// tests/stack/src/main.c
+//
+// `chg stack stress` drives every LED path (all states under all policies, with the band
+// lookup) on the maintenance thread; its high-water mark must leave a quarter of the stack
+// free. The measured use is printed, to size the CONFIG_CHG_MAINT_STACK_SIZE defaults from.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/shell/shell_dummy.h>
+#include <zmk_stub.h>
+
+#define STRESS_ROUNDS   20
+
+/* Run a shell command; returns its output. */
+static const char *chg_cmd(const char *cmd)
+{
+    const struct shell *sh = shell_backend_dummy_get_ptr();
+    size_t size;
+
+    shell_backend_dummy_clear_output(sh);
+    zassert_ok(shell_execute_cmd(sh, cmd), "`%s` failed", cmd);
+    return shell_backend_dummy_get_output(sh, &size);
+}
+
+static void *stack_setup(void)
+{
+    const struct shell *sh = shell_backend_dummy_get_ptr();
+
+    zassert_true(WAIT_FOR(shell_ready(sh), 1000000, k_msleep(1)));
+    return NULL;
+}
+
+ZTEST(stack, test_stress_headroom)
+{
+    const struct gpio_dt_spec stat = GPIO_DT_SPEC_GET(DT_NODELABEL(chg_stat), gpios);
+    const char *prefix = "chg_maint stack: ";
+
+    /* Charging with a sampled battery level, so the stress starts from the busiest state. */
+    zassert_ok(gpio_emul_input_set(stat.port, stat.pin, 0));
+    k_sleep(K_MSEC(50));
+    zmk_stub_battery_set(42);
+    k_sleep(K_MSEC(50));
+
+    const char *out = chg_cmd("chg stack stress " STRINGIFY(STRESS_ROUNDS));
+    const char *p = strstr(out, prefix);
+    zassert_not_null(p, "%s", out);
+
+    /* "<used> / <size> bytes used (high-water mark), <free> free" */
+    char *end;
+    unsigned long used = strtoul(p + strlen(prefix), &end, 10);
+    zassert_true(strncmp(end, " / ", 3) == 0, "%s", out);
+    unsigned long size = strtoul(end + 3, &end, 10);
+
+    TC_PRINT("chg_maint: %lu of %lu bytes used (CONFIG_CHG_MAINT_STACK_SIZE=%d)\n", used, size,
+             CONFIG_CHG_MAINT_STACK_SIZE);
+    zassert_true(used > 0 && used <= size, "%s", out);
+    zassert_true(size - used >= size / 4, "only %lu of %lu bytes left", size - used, size);
+}
+
+ZTEST_SUITE(stack, NULL, stack_setup, NULL, NULL, NULL);
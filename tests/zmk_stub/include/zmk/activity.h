@@ -0,0 +1,9 @@
+// tests/zmk_stub/include/zmk/activity.h
+
+#pragma once
+
+enum zmk_activity_state {
+    ZMK_ACTIVITY_ACTIVE,
+    ZMK_ACTIVITY_IDLE,
+    ZMK_ACTIVITY_SLEEP,
+};
@@ -0,0 +1,8 @@
+// tests/zmk_stub/include/zmk/battery.h
+
+#pragma once
+
+#include <stdint.h>
+
+/* Last battery level set with zmk_stub_battery_set() (0 until then, like ZMK before a sample). */
+uint8_t zmk_battery_state_of_charge(void);
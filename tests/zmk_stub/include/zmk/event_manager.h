@@ -0,0 +1,65 @@
+// tests/zmk_stub/include/zmk/event_manager.h
+//
+// ZMK event manager subset: events are raised synchronously to every subscribed listener, in
+// link order, like ZMK does from the raising thread.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/sys/iterable_sections.h>
+#include <zephyr/sys/util.h>
+
+struct zmk_event_type {
+    const char *name;
+};
+
+typedef struct {
+    const struct zmk_event_type *event;
+} zmk_event_t;
+
+struct zmk_listener {
+    int (*callback)(const zmk_event_t *eh);
+};
+
+struct zmk_event_subscription {
+    const struct zmk_event_type *event_type;
+    const struct zmk_listener *listener;
+};
+
+#define ZMK_EVENT_DECLARE(event_type)                                                       \
+    struct event_type##_event {                                                             \
+        zmk_event_t header;                                                                 \
+        struct event_type data;                                                             \
+    };                                                                                      \
+    extern const struct zmk_event_type zmk_event_##event_type;                              \
+    int raise_##event_type(struct event_type data);                                         \
+    struct event_type *as_##event_type(const zmk_event_t *eh)
+
+#define ZMK_EVENT_IMPL(event_type)                                                          \
+    const struct zmk_event_type zmk_event_##event_type = { .name = STRINGIFY(event_type) }; \
+    int raise_##event_type(struct event_type data)                                          \
+    {                                                                                       \
+        struct event_type##_event ev = {                                                    \
+            .header = { .event = &zmk_event_##event_type },                                 \
+            .data = data,                                                                   \
+        };                                                                                  \
+        return zmk_event_manager_raise(&ev.header);                                         \
+    }                                                                                       \
+    struct event_type *as_##event_type(const zmk_event_t *eh)                               \
+    {                                                                                       \
+        return eh->event == &zmk_event_##event_type                                         \
+                   ? &CONTAINER_OF(eh, struct event_type##_event, header)->data            \
+                   : NULL;                                                                  \
+    }
+
+#define ZMK_LISTENER(mod, cb) const struct zmk_listener zmk_listener_##mod = { .callback = cb }
+
+#define ZMK_SUBSCRIPTION(mod, ev_type)                                                      \
+    const STRUCT_SECTION_ITERABLE(zmk_event_subscription, zmk_event_sub_##mod##_##ev_type) = { \
+        .event_type = &zmk_event_##ev_type,                                                 \
+        .listener = &zmk_listener_##mod,                                                    \
+    }
+
+/* Call every listener of the event; a negative return stops the chain and is returned. */
+int zmk_event_manager_raise(zmk_event_t *event);
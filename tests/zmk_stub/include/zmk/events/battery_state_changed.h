@@ -0,0 +1,11 @@
+// tests/zmk_stub/include/zmk/events/battery_state_changed.h
+
+#pragma once
+
+#include <zmk/event_manager.h>
+
+struct zmk_battery_state_changed {
+    uint8_t state_of_charge;
+};
+
+ZMK_EVENT_DECLARE(zmk_battery_state_changed);
@@ -0,0 +1,15 @@
+// tests/zmk_stub/include/zmk/events/position_state_changed.h
+
+#pragma once
+
+#include <stdbool.h>
+#include <zmk/event_manager.h>
+
+struct zmk_position_state_changed {
+    uint8_t source;
+    uint32_t position;
+    bool state;
+    int64_t timestamp;
+};
+
+ZMK_EVENT_DECLARE(zmk_position_state_changed);
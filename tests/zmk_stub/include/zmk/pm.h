@@ -0,0 +1,6 @@
+// tests/zmk_stub/include/zmk/pm.h
+
+#pragma once
+
+/* Model of ZMK soft off up to sys_poweroff(); see tests/zmk_stub/src/zmk.c. */
+int zmk_pm_soft_off(void);
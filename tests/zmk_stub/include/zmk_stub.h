@@ -0,0 +1,24 @@
+// tests/zmk_stub/include/zmk_stub.h
+//
+// Test controls for the ZMK stand-ins.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/sys/atomic.h>
+
+/* Set the battery level and raise zmk_battery_state_changed, as ZMK's battery sampling does. */
+int zmk_stub_battery_set(uint8_t soc);
+
+/* Raise zmk_activity_state_changed (enum zmk_activity_state). */
+int zmk_stub_activity_set(int state);
+
+/* Keyboard sleep as ZMK's activity timer does it: SLEEP, then zmk_pm_soft_off(); ACTIVE again
+ * if soft off fails. Returns the soft off result.
+ */
+int zmk_stub_sleep(void);
+
+/* zmk_pm_soft_off() calls so far, and the result the next ones return (0: "powered off"). */
+extern atomic_t zmk_stub_soft_off_calls;
+extern int zmk_stub_soft_off_ret;
@@ -0,0 +1,28 @@
+// tests/zmk_stub/src/event_manager.c
+//
+// Synchronous dispatch to the ZMK_SUBSCRIPTION entries, and the events the module listens to.
+//
+
+#include <zephyr/sys/iterable_sections.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/activity_state_changed.h>
+#include <zmk/events/battery_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+
+int zmk_event_manager_raise(zmk_event_t *event)
+{
+    STRUCT_SECTION_FOREACH(zmk_event_subscription, sub) {
+        if (sub->event_type != event->event) {
+            continue;
+        }
+        int ret = sub->listener->callback(event);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+ZMK_EVENT_IMPL(zmk_activity_state_changed);
+ZMK_EVENT_IMPL(zmk_battery_state_changed);
+ZMK_EVENT_IMPL(zmk_position_state_changed);
@@ -0,0 +1,77 @@
+// tests/zmk_stub/src/zmk.c
+//
+// Battery level, activity and soft off as the module sees them from ZMK.
+// zmk_pm_soft_off() follows ZMK's order up to sys_poweroff(): wakeup is disabled on every device,
+// then each device left without wakeup that is not busy is suspended, with no PM notifiers.
+// Only the custom,chg-stat devices are walked (suspending the console would end the test).
+//
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/pm/device.h>
+#include <zmk/activity.h>
+#include <zmk/battery.h>
+#include <zmk/events/activity_state_changed.h>
+#include <zmk/events/battery_state_changed.h>
+#include <zmk/pm.h>
+#include <zmk_stub.h>
+
+static uint8_t battery_soc;
+
+atomic_t zmk_stub_soft_off_calls;
+int zmk_stub_soft_off_ret;
+
+uint8_t zmk_battery_state_of_charge(void)
+{
+    return battery_soc;
+}
+
+int zmk_stub_battery_set(uint8_t soc)
+{
+    battery_soc = soc;
+    return raise_zmk_battery_state_changed(
+        (struct zmk_battery_state_changed){ .state_of_charge = soc });
+}
+
+int zmk_stub_activity_set(int state)
+{
+    return raise_zmk_activity_state_changed(
+        (struct zmk_activity_state_changed){ .state = (enum zmk_activity_state)state });
+}
+
+#define STAT_DEV(node_id) DEVICE_DT_GET(node_id),
+
+static const struct device *const stat_devs[] = {
+    DT_FOREACH_STATUS_OKAY(custom_chg_stat, STAT_DEV)
+};
+
+int zmk_pm_soft_off(void)
+{
+    atomic_inc(&zmk_stub_soft_off_calls);
+    if (zmk_stub_soft_off_ret < 0) {
+        return zmk_stub_soft_off_ret;
+    }
+#if IS_ENABLED(CONFIG_PM_DEVICE)
+    for (size_t i = 0; i < ARRAY_SIZE(stat_devs); i++) {
+        (void)pm_device_wakeup_enable(stat_devs[i], false);
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(stat_devs); i++) {
+        if (pm_device_wakeup_is_enabled(stat_devs[i]) || pm_device_is_busy(stat_devs[i])) {
+            continue;
+        }
+        (void)pm_device_action_run(stat_devs[i], PM_DEVICE_ACTION_SUSPEND);
+    }
+#endif
+    /* sys_poweroff() would not return: the caller inspects the devices instead. */
+    return 0;
+}
+
+int zmk_stub_sleep(void)
+{
+    zmk_stub_activity_set(ZMK_ACTIVITY_SLEEP);
+    int ret = zmk_pm_soft_off();
+    if (ret < 0) {
+        zmk_stub_activity_set(ZMK_ACTIVITY_ACTIVE);
+    }
+    return ret;
+}
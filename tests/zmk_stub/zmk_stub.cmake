@@ -0,0 +1,11 @@
+# SPDX-License-Identifier: MIT
+#
+# The parts of ZMK the module uses (event manager, battery level, soft off), for test apps that
+# build the real module sources. Include after find_package(Zephyr) and project().
+
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/include)
+target_sources(app PRIVATE
+    ${CMAKE_CURRENT_LIST_DIR}/src/event_manager.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/zmk.c
+)
+zephyr_linker_sources(SECTIONS ${CMAKE_CURRENT_LIST_DIR}/zmk_stub.ld)